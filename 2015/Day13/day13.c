@@ -3,27 +3,35 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include "heldkarp.h"
 
 /* Constants */
 #define MAX_PEOPLE 10
 #define NAME_LEN 16
 
+/* Solver selection */
+#define SOLVER_HELD_KARP 0
+#define SOLVER_SYMMETRIC 1
+
 /* Global Variables */
 int happiness[MAX_PEOPLE][MAX_PEOPLE];
 char people_names[MAX_PEOPLE][NAME_LEN];
 int people_count = 0;
-int current_order[MAX_PEOPLE];
-int best_order[MAX_PEOPLE];
+unsigned char best_order[MAX_PEOPLE];
 long max_happiness = LONG_MIN;
 
+/* Symmetric search state */
+int pair_happiness[MAX_PEOPLE][MAX_PEOPLE];
+unsigned char seat_order[MAX_PEOPLE];
+long max_happiness_with_me = LONG_MIN;
+unsigned long arrangements;
+
 /* Function Prototypes */
 void init_happiness(void);
 int find_person(const char *name);
 int add_person(const char *name);
 void add_relation(const char *p1, const char *p2, int val);
-void solve(void);
-void permute(int start, int end);
-long calculate_total_happiness(void);
+void solve(unsigned char solver);
 void print_best_arrangement(void);
 
 void init_happiness(void) {
@@ -62,62 +70,105 @@ void add_relation(const char *p1, const char *p2, int val) {
 }
 
 /*
- * Calculate total happiness for a circular seating arrangement.
- * Each person i has two neighbors: (i-1) and (i+1).
- * We add the happiness 'current' feels sitting next to both.
+ * Held-Karp strategy.
+ * A circular table is a Hamiltonian cycle, so this runs the shared
+ * Held-Karp DP. Each neighbouring pair contributes both directions, so
+ * the edge weight is happiness[i][j] + happiness[j][i].
  */
-long calculate_total_happiness(void) {
-  long total = 0;
-  int i;
+void solve_held_karp(void) {
+  int i, j;
+  int best;
+
   for (i = 0; i < people_count; i++) {
-    int left = (i - 1 + people_count) % people_count;
-    int right = (i + 1) % people_count;
-    int current = current_order[i];
+    for (j = 0; j < people_count; j++) {
+      hk_weight[i][j] = happiness[i][j] + happiness[j][i];
+    }
+  }
 
-    total += (long)happiness[current][current_order[left]];
-    total += (long)happiness[current][current_order[right]];
+  best = hk_solve(people_count, 0, HK_MAXIMIZE, HK_CYCLE);
+  if (best != HK_NONE && (long)best > max_happiness) {
+    max_happiness = best;
+    hk_path(best_order);
   }
-  return total;
 }
 
-void swap(int *a, int *b) {
-  int temp = *a;
-  *a = *b;
-  *b = temp;
-}
+/*
+ * Symmetric strategy: place people seat by seat with person 0 fixed in
+ * seat 0 (rotations) and the person in seat 1 lower-numbered than the
+ * person in the last seat (reflections), so each ring is seen once.
+ * total accumulates pair_happiness as each seat is filled; weakest is
+ * the smallest pair on the ring so far.
+ */
+void seat_next(unsigned char depth, unsigned int free_mask, int total,
+               int weakest) {
+  unsigned char prev = seat_order[depth - 1];
+  unsigned char p;
+  unsigned int bit, rest;
+  int edge;
 
-void permute(int start, int end) {
-  int i;
-  if (start == end) {
-    long current = calculate_total_happiness();
-    if (current > max_happiness) {
-      max_happiness = current;
-      memcpy(best_order, current_order, sizeof(int) * people_count);
+  if (!free_mask) {
+    /* Close the ring back to seat 0 */
+    edge = pair_happiness[prev][0];
+    total += edge;
+    if (edge < weakest)
+      weakest = edge;
+    ++arrangements;
+    if (total > max_happiness) {
+      max_happiness = total;
+      memcpy(best_order, seat_order, people_count);
     }
+    /* Seating "me" (0 with everyone) replaces the weakest pair */
+    if ((long)(total - weakest) > max_happiness_with_me)
+      max_happiness_with_me = total - weakest;
     return;
   }
 
-  for (i = start; i <= end; i++) {
-    swap(&current_order[start], &current_order[i]);
-    permute(start + 1, end);
-    swap(&current_order[start], &current_order[i]); // backtrack
+  for (p = 1, bit = 2; p < people_count; p++, bit <<= 1) {
+    if (!(free_mask & bit))
+      continue;
+    rest = free_mask & ~bit;
+
+    /* Someone numbered above seat 1 must still be left for the last
+     * seat (or be placed there now) */
+    if (depth > 1 && ((rest ? rest : bit) >> (seat_order[1] + 1)) == 0)
+      continue;
+
+    edge = pair_happiness[prev][p];
+    seat_order[depth] = p;
+    seat_next(depth + 1, rest, total + edge, edge < weakest ? edge : weakest);
   }
 }
 
-/*
- * Entry point for finding the optimal arrangement.
- * To optimize, we fix the first person (index 0) and only permute
- * the remaining (n-1) people. This accounts for circular
- * rotation symmetry, reducing n! permutations to (n-1)!.
- */
-void solve(void) {
-  int i;
+void solve_symmetric(void) {
+  int i, j;
+
   for (i = 0; i < people_count; i++) {
-    current_order[i] = i;
+    for (j = 0; j < people_count; j++) {
+      pair_happiness[i][j] = happiness[i][j] + happiness[j][i];
+    }
+  }
+
+  arrangements = 0;
+  max_happiness_with_me = LONG_MIN;
+  seat_order[0] = 0;
+  if (people_count == 1) {
+    max_happiness = 0;
+    best_order[0] = 0;
+    return;
   }
+  seat_next(1, ((1u << people_count) - 1) & ~1u, 0, INT_MAX);
+}
 
-  /* Start permuting from index 1, keeping index 0 fixed */
-  permute(1, people_count - 1);
+/*
+ * Entry point for finding the optimal arrangement with the chosen
+ * strategy.
+ */
+void solve(unsigned char solver) {
+  if (solver == SOLVER_SYMMETRIC) {
+    solve_symmetric();
+  } else {
+    solve_held_karp();
+  }
 }
 
 void print_best_arrangement(void) {
@@ -132,6 +183,8 @@ void print_best_arrangement(void) {
 }
 
 void run_test_part1(void) {
+  unsigned char solver;
+
   printf("\n--- Part 1 Test ---\n");
   init_happiness();
 
@@ -148,13 +201,21 @@ void run_test_part1(void) {
   add_relation("David", "Bob", -7);
   add_relation("David", "Carol", 41);
 
-  solve();
-  print_best_arrangement();
+  for (solver = SOLVER_HELD_KARP; solver <= SOLVER_SYMMETRIC; solver++) {
+    printf("%s:\n", solver == SOLVER_HELD_KARP ? "Held-Karp DP"
+                                              : "Symmetric search");
+    max_happiness = LONG_MIN;
+    solve(solver);
+    print_best_arrangement();
+    if (solver == SOLVER_SYMMETRIC) {
+      printf("Rings evaluated: %lu\n", arrangements);
+    }
 
-  if (max_happiness == 330) {
-    printf("PART 1: (PASS)\n");
-  } else {
-    printf("PART 1: (FAIL) Expected 330\n");
+    if (max_happiness == 330) {
+      printf("PART 1: (PASS)\n");
+    } else {
+      printf("PART 1: (FAIL) Expected 330\n");
+    }
   }
 }
 
@@ -168,12 +229,18 @@ void run_test_part2(void) {
 
   /* Reset max_happiness to find new optimum */
   max_happiness = LONG_MIN;
-  solve();
+  solve(SOLVER_HELD_KARP);
   print_best_arrangement();
 
-  /* We don't have an expected value for Part 2 from the user,
-     but we can verify the logic works. */
-  printf("PART 2: Completed\n");
+  /* We don't have an expected value for Part 2 from the user, but the
+     symmetric search already derived it from the Part 1 rings without
+     adding a seat, so the two strategies must agree. */
+  printf("Symmetric search (no extra seat): %ld\n", max_happiness_with_me);
+  if (max_happiness == max_happiness_with_me) {
+    printf("PART 2: (PASS)\n");
+  } else {
+    printf("PART 2: (FAIL) Strategies disagree\n");
+  }
 }
 
 int main(void) {
@@ -37,9 +37,14 @@ void reset_reindeer(Reindeer *r);
 void update_reindeer_position(Reindeer *r);
 void simulate_second(Reindeer reindeer_list[], int count, int award_points);
 void run_race_simulation(Reindeer reindeer_list[], int count, int total_seconds, int award_points);
+int distance_after(const Reindeer *r, int seconds);
+int seconds_until_switch(const Reindeer *r);
+void award_interval(Reindeer reindeer_list[], int count, int length);
+void run_race_events(Reindeer reindeer_list[], int count, int total_seconds);
 int simulate_race(Reindeer reindeer_list[], int count, int total_seconds);
 int simulate_race_with_points(Reindeer reindeer_list[], int count, int total_seconds);
 void setup_test_reindeer(Reindeer reindeer_list[], int *reindeer_count);
+void setup_race_reindeer(Reindeer reindeer_list[], int *reindeer_count);
 
 /* Initialize reindeer array */
 void init_reindeer(Reindeer reindeer_list[], int *reindeer_count) {
@@ -72,6 +77,20 @@ void setup_test_reindeer(Reindeer reindeer_list[], int *reindeer_count) {
     add_reindeer(reindeer_list, reindeer_count, "Dancer", 16, 11, 162);
 }
 
+/* A full-size field of nine reindeer, like a real puzzle input */
+void setup_race_reindeer(Reindeer reindeer_list[], int *reindeer_count) {
+    init_reindeer(reindeer_list, reindeer_count);
+    add_reindeer(reindeer_list, reindeer_count, "Vixen", 19, 7, 124);
+    add_reindeer(reindeer_list, reindeer_count, "Rudolph", 3, 15, 28);
+    add_reindeer(reindeer_list, reindeer_count, "Donner", 19, 9, 164);
+    add_reindeer(reindeer_list, reindeer_count, "Blitzen", 19, 9, 158);
+    add_reindeer(reindeer_list, reindeer_count, "Comet", 13, 7, 82);
+    add_reindeer(reindeer_list, reindeer_count, "Cupid", 25, 6, 145);
+    add_reindeer(reindeer_list, reindeer_count, "Dasher", 14, 3, 38);
+    add_reindeer(reindeer_list, reindeer_count, "Dancer", 3, 16, 37);
+    add_reindeer(reindeer_list, reindeer_count, "Prancer", 25, 6, 143);
+}
+
 /* Reset reindeer to initial state */
 void reset_reindeer(Reindeer *r) {
     r->distance = 0;
@@ -130,7 +149,7 @@ void simulate_second(Reindeer reindeer_list[], int count, int award_points) {
     }
 }
 
-/* Run the race simulation for specified duration */
+/* Run the second-by-second simulation (reference for the event-driven race) */
 void run_race_simulation(Reindeer reindeer_list[], int count, int total_seconds, int award_points) {
     int i;
 
@@ -145,15 +164,126 @@ void run_race_simulation(Reindeer reindeer_list[], int count, int total_seconds,
     }
 }
 
-/* Simulate race and return max distance */
+/* Closed form: full fly/rest cycles plus the flying part of the last one */
+int distance_after(const Reindeer *r, int seconds) {
+    int cycle = r->fly_time + r->rest_time;
+    int flown = (seconds / cycle) * r->fly_time;
+    int rest = seconds % cycle;
+
+    flown += (rest < r->fly_time) ? rest : r->fly_time;
+    return flown * r->speed;
+}
+
+/* Seconds until this reindeer next starts or stops flying */
+int seconds_until_switch(const Reindeer *r) {
+    int phase = (r->state == REINDEER_FLYING) ? r->fly_time : r->rest_time;
+    return phase - r->time_in_current_state;
+}
+
+/*
+ * Award points for 'length' seconds in which nobody changes state, so each
+ * distance grows linearly. Instead of scanning every second, find the
+ * leaders after the next second and how long they stay ahead: tied leaders
+ * with different speeds split after one second, otherwise the lead holds
+ * until the first faster reindeer closes the gap (ceil(gap / speed diff)).
+ */
+void award_interval(Reindeer reindeer_list[], int count, int length) {
+    int k = 1;
+    int i, lead, lead_speed, span, catch_up, dist, gap, diff, v;
+    int mixed;
+
+    while (k <= length) {
+        /* Leading distance and speed after k seconds */
+        lead = -1;
+        lead_speed = 0;
+        mixed = 0;
+        for (i = 0; i < count; i++) {
+            v = (reindeer_list[i].state == REINDEER_FLYING) ? reindeer_list[i].speed : 0;
+            dist = reindeer_list[i].distance + v * k;
+            if (dist > lead) {
+                lead = dist;
+                lead_speed = v;
+                mixed = 0;
+            } else if (dist == lead && v != lead_speed) {
+                mixed = 1;
+            }
+        }
+
+        /* Seconds (from k) for which the same reindeer keep the lead */
+        span = length - k + 1;
+        if (mixed) {
+            span = 1;
+        } else {
+            for (i = 0; i < count; i++) {
+                v = (reindeer_list[i].state == REINDEER_FLYING) ? reindeer_list[i].speed : 0;
+                diff = v - lead_speed;
+                if (diff <= 0)
+                    continue;
+                gap = lead - (reindeer_list[i].distance + v * k);
+                if (gap <= 0)
+                    continue;
+                catch_up = (gap + diff - 1) / diff;
+                if (catch_up < span)
+                    span = catch_up;
+            }
+        }
+
+        for (i = 0; i < count; i++) {
+            v = (reindeer_list[i].state == REINDEER_FLYING) ? reindeer_list[i].speed : 0;
+            if (reindeer_list[i].distance + v * k == lead) {
+                reindeer_list[i].points += span;
+            }
+        }
+        k += span;
+    }
+}
+
+/*
+ * Event-driven race with points: jump from one state change to the next,
+ * awarding each interval's leader spans in one step.
+ */
+void run_race_events(Reindeer reindeer_list[], int count, int total_seconds) {
+    int elapsed = 0;
+    int length, i, phase;
+    Reindeer *r;
+
+    for (i = 0; i < count; i++) {
+        reset_reindeer(&reindeer_list[i]);
+    }
+
+    while (elapsed < total_seconds) {
+        length = total_seconds - elapsed;
+        for (i = 0; i < count; i++) {
+            phase = seconds_until_switch(&reindeer_list[i]);
+            if (phase < length)
+                length = phase;
+        }
+
+        award_interval(reindeer_list, count, length);
+
+        for (i = 0; i < count; i++) {
+            r = &reindeer_list[i];
+            if (r->state == REINDEER_FLYING)
+                r->distance += r->speed * length;
+            r->time_in_current_state += length;
+            if (seconds_until_switch(r) == 0) {
+                r->state = (r->state == REINDEER_FLYING) ? REINDEER_RESTING : REINDEER_FLYING;
+                r->time_in_current_state = 0;
+            }
+        }
+        elapsed += length;
+    }
+}
+
+/* Race distances in closed form, O(reindeer); returns the max distance */
 int simulate_race(Reindeer reindeer_list[], int count, int total_seconds) {
     int max_distance;
     int i;
 
-    run_race_simulation(reindeer_list, count, total_seconds, 0);
-
     max_distance = 0;
     for (i = 0; i < count; i++) {
+        reset_reindeer(&reindeer_list[i]);
+        reindeer_list[i].distance = distance_after(&reindeer_list[i], total_seconds);
         if (reindeer_list[i].distance > max_distance) {
             max_distance = reindeer_list[i].distance;
         }
@@ -166,7 +296,7 @@ int simulate_race_with_points(Reindeer reindeer_list[], int count, int total_sec
     int max_points;
     int i;
 
-    run_race_simulation(reindeer_list, count, total_seconds, 1);
+    run_race_events(reindeer_list, count, total_seconds);
 
     max_points = 0;
     for (i = 0; i < count; i++) {
@@ -228,25 +358,52 @@ void run_test_part2(void) {
     }
 }
 
+/* The event-driven race must award exactly what the per-second one does */
+void run_cross_check(void) {
+    static int expected[MAX_REINDEER];
+    int count;
+    int i;
+    int ok = 1;
+
+    printf("\n--- Cross-check vs. per-second race ---\n");
+    setup_race_reindeer(global_reindeer, &count);
+    run_race_simulation(global_reindeer, count, RACE_DURATION, 1);
+    for (i = 0; i < count; i++) {
+        expected[i] = global_reindeer[i].points;
+        if (global_reindeer[i].distance != distance_after(&global_reindeer[i], RACE_DURATION)) {
+            ok = 0;
+        }
+    }
+    simulate_race_with_points(global_reindeer, count, RACE_DURATION);
+    for (i = 0; i < count; i++) {
+        if (global_reindeer[i].points != expected[i]) {
+            ok = 0;
+        }
+    }
+    printf(ok ? "CROSS-CHECK: (PASS)\n" : "CROSS-CHECK: (FAIL)\n");
+}
+
 void run_final_race(void) {
     int final_count;
     int max_distance;
     int max_points;
 
     printf("\n--- Final Race (2503 seconds) ---\n");
-    setup_test_reindeer(global_reindeer, &final_count);
+    setup_race_reindeer(global_reindeer, &final_count);
 
     /* Part 1: Distance-based winner */
     printf("Running Part 1: Distance-based race...\n");
     max_distance = simulate_race(global_reindeer, final_count, RACE_DURATION);
     printf("Part 1 - After %d seconds, the winning reindeer traveled %d km!\n",
            RACE_DURATION, max_distance);
+    printf(max_distance == 2660 ? "PART 1: (PASS)\n" : "PART 1: (FAIL) Expected 2660 km\n");
 
     /* Part 2: Points-based winner */
     printf("Running Part 2: Points-based race...\n");
     max_points = simulate_race_with_points(global_reindeer, final_count, RACE_DURATION);
     printf("Part 2 - After %d seconds, the winning reindeer earned %d points!\n",
            RACE_DURATION, max_points);
+    printf(max_points == 1256 ? "PART 2: (PASS)\n" : "PART 2: (FAIL) Expected 1256 points\n");
 }
 
 int main(void) {
@@ -257,6 +414,7 @@ int main(void) {
     run_test_part1();
     run_test_part2();
     run_final_race();
+    run_cross_check();
 
     printf("\nPress any key to exit...\n");
     cgetc();
@@ -27,12 +27,35 @@ typedef struct {
   int calories;
 } Ingredient;
 
+/* Properties in the order used by the search tables */
+#define PROP_CAPACITY 0
+#define PROP_DURABILITY 1
+#define PROP_FLAVOR 2
+#define PROP_TEXTURE 3
+#define PROP_CALORIES 4
+#define SCORED_PROPS 4 /* calories do not count towards the score */
+#define NUM_PROPS 5
+
 /* Recipe search state */
 typedef struct {
   long best_score_part1;
   long best_score_part2;
+  unsigned long scored_part1; /* recipes whose score was multiplied out */
+  unsigned long scored_part2;
 } SearchState;
 
+/*
+ * Tables for the pruned search: per-ingredient coefficients, and for each
+ * ingredient index the largest / smallest coefficient among it and all
+ * later ingredients
+ */
+typedef struct {
+  int count;
+  int coef[MAX_INGREDIENTS][NUM_PROPS];
+  int max_rest[MAX_INGREDIENTS][NUM_PROPS];
+  int min_rest[MAX_INGREDIENTS][NUM_PROPS];
+} SearchTables;
+
 /* Property breakdown for debugging */
 typedef struct {
   long capacity;
@@ -51,12 +74,14 @@ long calculate_score(const Ingredient ingredients[], int ingredient_count,
 void calculate_properties(const Ingredient ingredients[], int ingredient_count,
                           const int amounts[], PropertyBreakdown *props);
 void print_property_breakdown(const int amounts[]);
-void try_combinations(const Ingredient ingredients[], int ingredient_count,
-                      int current_index, int remaining, int amounts[],
-                      SearchState *state);
+void search_part1(const SearchTables *tables, SearchState *state, int index,
+                  int remaining, const int totals[]);
+void search_part2(const SearchTables *tables, SearchState *state, int index,
+                  int remaining, const int totals[]);
 void find_optimal_recipe(const Ingredient ingredients[], int ingredient_count,
                          SearchState *state);
 void run_tests(void);
+void run_full_input(void);
 
 /*
  * Add an ingredient to the list
@@ -144,62 +169,195 @@ void print_property_breakdown(const int amounts[]) {
 }
 
 /*
- * Recursive function to try all combinations of ingredient amounts
+ * Score of fully accumulated totals. The three long multiplies are only
+ * done once every scored property is positive.
  */
-void try_combinations(const Ingredient ingredients[], int ingredient_count,
-                      int current_index, int remaining, int amounts[],
-                      SearchState *state) {
+static long score_totals(const int totals[], unsigned long *scored) {
+  int k;
+
+  for (k = 0; k < SCORED_PROPS; k++) {
+    if (totals[k] <= 0)
+      return 0;
+  }
+  (*scored)++;
+  return (long)totals[PROP_CAPACITY] * totals[PROP_DURABILITY] *
+         totals[PROP_FLAVOR] * totals[PROP_TEXTURE];
+}
+
+/*
+ * Can any way of spending 'remaining' teaspoons on ingredients index..
+ * beat 'best'? Each property is at most its running total plus
+ * remaining times the largest coefficient still available. If any such
+ * bound is <= 0 the score is 0; otherwise their product bounds the score.
+ */
+static int can_beat(const SearchTables *tables, int index, int remaining,
+                    const int totals[], long best) {
+  long bound[SCORED_PROPS];
+  long product;
+  int k;
+
+  for (k = 0; k < SCORED_PROPS; k++) {
+    bound[k] = totals[k] + (long)remaining * tables->max_rest[index][k];
+    if (bound[k] <= 0)
+      return 0;
+  }
+
+  /* product > best, evaluated without overflowing 32 bits */
+  product = bound[0] * bound[1];
+  for (k = 2; k < SCORED_PROPS; k++) {
+    if (product > best / bound[k])
+      return 1;
+    product *= bound[k];
+  }
+  return product > best;
+}
+
+/* Add 'amount' teaspoons of ingredient 'index' to 'totals' */
+static void add_amount(const SearchTables *tables, int totals[], int index,
+                       int amount) {
+  int k;
+
+  for (k = 0; k < NUM_PROPS; k++) {
+    totals[k] += tables->coef[index][k] * amount;
+  }
+}
+
+/*
+ * Part 1: fix the amount of ingredient 'index'. Totals are carried down
+ * and updated by one coefficient add per extra teaspoon; the last
+ * ingredient takes whatever is left.
+ */
+void search_part1(const SearchTables *tables, SearchState *state, int index,
+                  int remaining, const int totals[]) {
+  int t[NUM_PROPS];
+  int amount, k;
   long score;
-  int amount;
 
-  /* Base case: Last ingredient gets all remaining teaspoons */
-  if (current_index == ingredient_count - 1) {
-    amounts[current_index] = remaining;
+  memcpy(t, totals, sizeof(t));
 
-    /* Calculate score for Part 1 (no calorie constraint) */
-    score = calculate_score(ingredients, ingredient_count, amounts,
-                            IGNORE_CALORIES);
-    if (score > state->best_score_part1) {
+  if (index == tables->count - 1) {
+    add_amount(tables, t, index, remaining);
+    score = score_totals(t, &state->scored_part1);
+    if (score > state->best_score_part1)
       state->best_score_part1 = score;
-    }
+    return;
+  }
 
-    /* Calculate score for Part 2 (with calorie constraint) */
-    score =
-        calculate_score(ingredients, ingredient_count, amounts, CHECK_CALORIES);
-    if (score > state->best_score_part2) {
-      state->best_score_part2 = score;
+  for (amount = 0; amount <= remaining; amount++) {
+    if (can_beat(tables, index + 1, remaining - amount, t,
+                 state->best_score_part1)) {
+      search_part1(tables, state, index + 1, remaining - amount, t);
     }
+    for (k = 0; k < NUM_PROPS; k++) {
+      t[k] += tables->coef[index][k];
+    }
+  }
+}
 
+/*
+ * Part 2: like part 1, but only recipes on the calorie line are visited.
+ * Branches whose remaining teaspoons cannot hit CALORIE_TARGET are cut,
+ * and the last two amounts are solved from the calorie equation
+ * a * cal[n-2] + (remaining - a) * cal[n-1] = calories still needed.
+ */
+void search_part2(const SearchTables *tables, SearchState *state, int index,
+                  int remaining, const int totals[]) {
+  int t[NUM_PROPS];
+  int amount, left, need, c1, c2, k;
+  long score;
+
+  memcpy(t, totals, sizeof(t));
+  need = CALORIE_TARGET - t[PROP_CALORIES];
+
+  if (index == tables->count - 1) {
+    if (need != tables->coef[index][PROP_CALORIES] * remaining)
+      return;
+    add_amount(tables, t, index, remaining);
+    score = score_totals(t, &state->scored_part2);
+    if (score > state->best_score_part2)
+      state->best_score_part2 = score;
     return;
   }
 
-  /* Try different amounts for current ingredient */
+  if (index == tables->count - 2) {
+    c1 = tables->coef[index][PROP_CALORIES];
+    c2 = tables->coef[index + 1][PROP_CALORIES];
+    if (c1 == c2) {
+      /* every split has the same calories: fall through to the loop */
+      if (need != c1 * remaining)
+        return;
+    } else {
+      need -= c2 * remaining;
+      if (need % (c1 - c2) != 0)
+        return;
+      amount = need / (c1 - c2);
+      if (amount < 0 || amount > remaining)
+        return;
+      add_amount(tables, t, index, amount);
+      search_part2(tables, state, index + 1, remaining - amount, t);
+      return;
+    }
+  }
+
   for (amount = 0; amount <= remaining; amount++) {
-    amounts[current_index] = amount;
-    try_combinations(ingredients, ingredient_count, current_index + 1,
-                     remaining - amount, amounts, state);
+    need = CALORIE_TARGET - t[PROP_CALORIES];
+    left = remaining - amount;
+    if (need >= left * tables->min_rest[index + 1][PROP_CALORIES] &&
+        need <= left * tables->max_rest[index + 1][PROP_CALORIES] &&
+        can_beat(tables, index + 1, left, t, state->best_score_part2)) {
+      search_part2(tables, state, index + 1, left, t);
+    }
+    for (k = 0; k < NUM_PROPS; k++) {
+      t[k] += tables->coef[index][k];
+    }
   }
 }
 
 /*
- * Find the optimal recipe by trying all possible combinations
+ * Find the optimal recipes with the pruned incremental searches
  */
 void find_optimal_recipe(const Ingredient ingredients[], int ingredient_count,
                          SearchState *state) {
-  int amounts[MAX_INGREDIENTS];
+  SearchTables tables;
+  int totals[NUM_PROPS];
+  int i, k;
 
-  /* Initialize amounts array to zero using memset */
-  memset(amounts, 0, sizeof(amounts));
+  /* Coefficient tables, then suffix max/min for the bounds */
+  for (i = 0; i < ingredient_count; i++) {
+    tables.coef[i][PROP_CAPACITY] = ingredients[i].capacity;
+    tables.coef[i][PROP_DURABILITY] = ingredients[i].durability;
+    tables.coef[i][PROP_FLAVOR] = ingredients[i].flavor;
+    tables.coef[i][PROP_TEXTURE] = ingredients[i].texture;
+    tables.coef[i][PROP_CALORIES] = ingredients[i].calories;
+  }
+  for (i = ingredient_count - 1; i >= 0; i--) {
+    for (k = 0; k < NUM_PROPS; k++) {
+      tables.max_rest[i][k] = tables.coef[i][k];
+      tables.min_rest[i][k] = tables.coef[i][k];
+      if (i + 1 < ingredient_count) {
+        if (tables.max_rest[i + 1][k] > tables.max_rest[i][k])
+          tables.max_rest[i][k] = tables.max_rest[i + 1][k];
+        if (tables.min_rest[i + 1][k] < tables.min_rest[i][k])
+          tables.min_rest[i][k] = tables.min_rest[i + 1][k];
+      }
+    }
+  }
+  tables.count = ingredient_count;
 
   /* Reset best scores */
   state->best_score_part1 = 0;
   state->best_score_part2 = 0;
+  state->scored_part1 = 0;
+  state->scored_part2 = 0;
 
   printf("EVALUATING %d INGREDIENTS...\n", ingredient_count);
 
-  /* Start recursive search */
-  try_combinations(ingredients, ingredient_count, 0, TOTAL_TEASPOONS, amounts,
-                   state);
+  memset(totals, 0, sizeof(totals));
+  search_part1(&tables, state, 0, TOTAL_TEASPOONS, totals);
+  search_part2(&tables, state, 0, TOTAL_TEASPOONS, totals);
+
+  printf("RECIPES SCORED: %lu (PART 1), %lu (PART 2)\n", state->scored_part1,
+         state->scored_part2);
 }
 
 /*
@@ -280,6 +438,37 @@ void run_tests(void) {
   printf(pass ? " (PASS)\n" : " (FAIL)\n");
 }
 
+/*
+ * Four ingredients, the size of a real puzzle input: 176,851 recipes
+ * for an exhaustive search
+ */
+void run_full_input(void) {
+  Ingredient ingredients[MAX_INGREDIENTS];
+  int ingredient_count = 0;
+  SearchState state;
+  int pass;
+
+  printf("\n=== 4-INGREDIENT INPUT ===\n\n");
+
+  add_ingredient(ingredients, &ingredient_count, "Sprinkles", 2, 0, -2, 0, 3);
+  add_ingredient(ingredients, &ingredient_count, "Butterscotch", 0, 5, -3, 0,
+                 3);
+  add_ingredient(ingredients, &ingredient_count, "Chocolate", 0, 0, 5, -1, 8);
+  add_ingredient(ingredients, &ingredient_count, "Candy", 0, -1, 0, 5, 8);
+
+  find_optimal_recipe(ingredients, ingredient_count, &state);
+
+  printf("PART 1 - BEST SCORE: %ld\n", state.best_score_part1);
+  printf("  EXPECTED: 21367368");
+  pass = (state.best_score_part1 == 21367368L);
+  printf(pass ? " (PASS)\n" : " (FAIL)\n");
+
+  printf("\nPART 2 - BEST SCORE (500 CAL): %ld\n", state.best_score_part2);
+  printf("  EXPECTED: 1766400");
+  pass = (state.best_score_part2 == 1766400L);
+  printf(pass ? " (PASS)\n" : " (FAIL)\n");
+}
+
 /*
  * Main program
  */
@@ -290,6 +479,7 @@ int main(void) {
   printf("C64 EDITION\n");
 
   run_tests();
+  run_full_input();
 
   printf("\n=== ALL TESTS COMPLETE ===\n");
 
@@ -3,29 +3,57 @@
  * No Such Thing as Too Much
  *
  * Solution for Commodore 64 (cc65)
+ *
+ * Build with -DBENCHMARK on a PC to time the DP against the recursion
+ * (see "make bench").
  */
 
 #include <limits.h>
 #include <stdio.h>
+#include <string.h>
+#ifdef BENCHMARK
+#include <time.h>
+#endif
 
 /* Configuration */
 #define MAX_CONTAINERS 20
+#define MAX_TARGET 150
 
-/* Global state
- * Using a simple array for containers.
- * For the sample input:
- * Containers: 20, 15, 10, 5, 5
- * Target: 25
- */
-unsigned char containers[] = {20, 15, 10, 5, 5};
-unsigned char num_containers = sizeof(containers) / sizeof(containers[0]);
-unsigned int target = 25;
+/* Sample input from the puzzle description */
+unsigned char sample_containers[] = {20, 15, 10, 5, 5};
+
+/* A real-sized input: 20 containers, 150 liters */
+unsigned char full_containers[] = {33, 14, 18, 20, 45, 35, 16, 35, 1, 13,
+                                   18, 13, 50, 44, 48, 6,  24, 41, 30, 42};
+
+/* Global state: the data set being solved */
+unsigned char *containers;
+unsigned char num_containers;
+unsigned int target;
 
 /* Results */
 unsigned long part1_ans = 0;
 unsigned long part2_ans = 0;
 unsigned int min_containers = INT_MAX;
 
+/**
+ * ways[s][c]: number of subsets of the containers seen so far that hold
+ * exactly s liters using c containers. 151 x 21 longs = 12.7 KB.
+ */
+unsigned long ways[MAX_TARGET + 1][MAX_CONTAINERS + 1];
+
+void use_data(unsigned char *list, unsigned char count, unsigned int liters) {
+  containers = list;
+  num_containers = count;
+  target = liters;
+}
+
+void reset_results(void) {
+  part1_ans = 0;
+  part2_ans = 0;
+  min_containers = INT_MAX;
+}
+
 /**
  * Recursive solver
  * index: current container index
@@ -59,23 +87,119 @@ void solve(unsigned char index, unsigned int current_sum, unsigned char count) {
   solve(index + 1, current_sum, count);
 }
 
-int main(void) {
-  printf("\n--- AoC 2015 Day 17 ---\n");
+void solve_recursive(void) {
+  reset_results();
+  solve(0, 0, 0);
+}
+
+/**
+ * Subset-sum DP over (sum, count), O(n * target * n).
+ * Each container is added once, walking sums and counts downwards so the
+ * entries it reads have not yet been updated for the same container.
+ * Part 1 sums row `target`; part 2 is its first non-zero column.
+ */
+void solve_dp(void) {
+  unsigned char i, c, top;
+  unsigned int s, w;
+  unsigned long *dst;
+  unsigned long *src;
+
+  reset_results();
+  memset(ways, 0, sizeof(ways));
+  ways[0][0] = 1;
+
+  for (i = 0; i < num_containers; ++i) {
+    w = containers[i];
+    if (w == 0 || w > target) continue;
+    top = i + 1; /* at most i + 1 containers used so far */
+    for (s = target; s >= w; --s) {
+      dst = ways[s];
+      src = ways[s - w];
+      for (c = top; c > 0; --c) {
+        dst[c] += src[c - 1];
+      }
+    }
+  }
+
+  for (c = 1; c <= num_containers; ++c) {
+    if (ways[target][c] == 0) continue;
+    part1_ans += ways[target][c];
+    if (min_containers == INT_MAX) {
+      min_containers = c;
+      part2_ans = ways[target][c];
+    }
+  }
+}
+
+void print_results(const char *label) {
+  printf("%s\n", label);
+  printf("  Part 1 Combinations: %lu\n", part1_ans);
+  printf("  Min Containers: %u\n", min_containers);
+  printf("  Part 2 Combinations: %lu\n", part2_ans);
+}
+
+void print_data(void) {
+  unsigned char i;
   printf("Target: %u liters\n", target);
   printf("Containers: ");
-  {
-    unsigned char i;
-    for (i = 0; i < num_containers; ++i) {
-      printf("%d ", containers[i]);
-    }
+  for (i = 0; i < num_containers; ++i) {
+    printf("%d ", containers[i]);
   }
-  printf("\n\nComputing...\n");
+  printf("\n");
+}
 
-  solve(0, 0, 0);
+#ifdef BENCHMARK
+#define BENCH_RUNS 200
+
+/* Time BENCH_RUNS solves of the current data set, in milliseconds each */
+double time_solver(void (*solver)(void)) {
+  clock_t start;
+  unsigned int run;
+
+  start = clock();
+  for (run = 0; run < BENCH_RUNS; ++run) {
+    solver();
+  }
+  return (double)(clock() - start) * 1000.0 / CLOCKS_PER_SEC / BENCH_RUNS;
+}
+
+void run_benchmark(void) {
+  double t_rec, t_dp;
+
+  printf("\nNative benchmark (%d runs each):\n", BENCH_RUNS);
+  use_data(full_containers, sizeof(full_containers), 150);
+  t_rec = time_solver(solve_recursive);
+  print_results("Recursion:");
+  t_dp = time_solver(solve_dp);
+  print_results("DP:");
+  printf("Recursion: %.3f ms, DP: %.3f ms (%.0fx)\n", t_rec, t_dp,
+         t_dp > 0 ? t_rec / t_dp : 0.0);
+}
+#endif
+
+int main(void) {
+  printf("\n--- AoC 2015 Day 17 ---\n");
+
+  /* Sample: both solvers must agree (expected 4, min 2, 3 ways) */
+  use_data(sample_containers, sizeof(sample_containers), 25);
+  print_data();
+  printf("\nComputing...\n");
+  solve_recursive();
+  print_results("Recursion:");
+  solve_dp();
+  print_results("DP:");
+
+  /* Real-sized input: the DP only (expected 1304, min 4, 18 ways) */
+  printf("\n");
+  use_data(full_containers, sizeof(full_containers), 150);
+  print_data();
+  printf("\nComputing...\n");
+  solve_dp();
+  print_results("DP:");
 
-  printf("Part 1 Combinations: %lu\n", part1_ans);
-  printf("Min Containers: %u\n", min_containers);
-  printf("Part 2 Combinations: %lu\n", part2_ans);
+#ifdef BENCHMARK
+  run_benchmark();
+#endif
 
   return 0;
 }
@@ -2,18 +2,62 @@
 #include <stdlib.h>
 #include <string.h>
 #include <time.h>
+#ifdef __CC65__
+#include <conio.h>
+#include "vicscreen.h"
+#endif
 
 #define MAX_SIZE 100
 // Add padding for sentinel borders (1 on each side)
 #define BUFFER_SIZE (MAX_SIZE + 2)
 
-// Globals to store grid state
-// 0 = OFF, 1 = ON
-static unsigned char current_grid[BUFFER_SIZE][BUFFER_SIZE];
-static unsigned char next_grid[BUFFER_SIZE][BUFFER_SIZE];
+// Cells are bit-packed: each word holds a run of a row, bit j of word i
+// being column (i - 1) * LWORD_BITS + j + 1. Words are the widest type that
+// is cheap on the target.
+#ifdef __CC65__
+typedef unsigned char lword;
+#define LWORD_BITS 8
+#else
+#include <stdint.h>
+typedef uint64_t lword;
+#define LWORD_BITS 64
+#endif
+
+// Words per row, plus an always-zero sentinel word on each side
+#define ROW_WORDS ((MAX_SIZE + LWORD_BITS - 1) / LWORD_BITS + 2)
+
+// Globals to store grid state, swapped by pointer after each step
+static lword grid_a[BUFFER_SIZE][ROW_WORDS];
+static lword grid_b[BUFFER_SIZE][ROW_WORDS];
+static lword (*current_grid)[ROW_WORDS] = grid_a;
+static lword (*next_grid)[ROW_WORDS] = grid_b;
+
+// Cells inside the grid width, and the two corner cells of a row
+static lword edge_mask[ROW_WORDS];
+static lword corner_mask[ROW_WORDS];
+
+// Horizontal 3-cell sums (2 bits: lo, hi) of the rows above, at and below
+// the row being computed; rotated as the step moves down
+static lword sum_lo[3][ROW_WORDS];
+static lword sum_hi[3][ROW_WORDS];
 
 static int grid_width = 0;
 static int grid_height = 0;
+static unsigned char row_words = 0;
+
+// Tiles are one word wide and TILE_ROWS rows high (8x8 cells on the C64).
+// A tile is only recomputed if it or one of its 8 neighbours changed in the
+// last step; the arrays have a border of never-set flags.
+#define TILE_ROWS 8
+#define TILE_GRID_ROWS ((MAX_SIZE + TILE_ROWS - 1) / TILE_ROWS + 2)
+static unsigned char tile_changed[TILE_GRID_ROWS][ROW_WORDS];
+static unsigned char tile_dirty[TILE_GRID_ROWS][ROW_WORDS];
+static unsigned char tile_rows = 0;
+static unsigned int tiles_skipped = 0;
+static unsigned long total_skipped = 0;
+
+// Lights on, kept up to date by every step
+static int light_count = 0;
 
 // Sample 6x6 input for testing or fallback
 const char *sample_input[] = {".#.#.#", "...##.", "#....#",
@@ -21,8 +65,83 @@ const char *sample_input[] = {".#.#.#", "...##.", "#....#",
 
 // Initialize grids to 0 (all off)
 void clear_grids() {
-  memset(current_grid, 0, sizeof(current_grid));
-  memset(next_grid, 0, sizeof(next_grid));
+  memset(tile_changed, 0, sizeof(tile_changed));
+  current_grid = grid_a;
+  next_grid = grid_b;
+  memset(grid_a, 0, sizeof(grid_a));
+  memset(grid_b, 0, sizeof(grid_b));
+}
+
+void set_cell(int r, int c) {
+  --c;
+  current_grid[r][1 + c / LWORD_BITS] |= (lword)1 << (c % LWORD_BITS);
+  tile_changed[1 + (r - 1) / TILE_ROWS][1 + c / LWORD_BITS] = 1;
+}
+
+unsigned char get_cell(int r, int c) {
+  --c;
+  return (unsigned char)((current_grid[r][1 + c / LWORD_BITS] >>
+                          (c % LWORD_BITS)) & 1);
+}
+
+// Number of set bits in each byte value
+static unsigned char bit_count[256];
+
+void setup_bit_count() {
+  int i;
+  for (i = 1; i < 256; ++i) {
+    bit_count[i] = (unsigned char)((i & 1) + bit_count[i >> 1]);
+  }
+}
+
+unsigned char count_bits(lword w) {
+#if defined(__GNUC__) && !defined(__CC65__)
+  return (unsigned char)__builtin_popcountll(w);
+#else
+  unsigned char n = 0;
+  while (w) {
+    n += bit_count[(unsigned char)w];
+    w >>= 4;
+    w >>= 4;
+  }
+  return n;
+#endif
+}
+
+// Count every light from scratch
+int recount_lights() {
+  int count = 0;
+  int r;
+  unsigned char i;
+  for (r = 1; r <= grid_height; ++r) {
+    for (i = 1; i <= row_words; ++i) {
+      count += count_bits(current_grid[r][i]);
+    }
+  }
+  return count;
+}
+
+// Build the row masks once the grid size is known; every tile starts dirty
+void setup_masks() {
+  int r, c;
+
+  row_words = (unsigned char)((grid_width + LWORD_BITS - 1) / LWORD_BITS);
+  memset(edge_mask, 0, sizeof(edge_mask));
+  memset(corner_mask, 0, sizeof(corner_mask));
+  for (c = 0; c < grid_width; ++c) {
+    edge_mask[1 + c / LWORD_BITS] |= (lword)1 << (c % LWORD_BITS);
+  }
+  corner_mask[1] |= 1;
+  c = grid_width - 1;
+  corner_mask[1 + c / LWORD_BITS] |= (lword)1 << (c % LWORD_BITS);
+
+  tile_rows = (unsigned char)((grid_height + TILE_ROWS - 1) / TILE_ROWS);
+  memset(tile_changed, 0, sizeof(tile_changed));
+  for (r = 1; r <= tile_rows; ++r) {
+    memset(&tile_changed[r][1], 1, row_words);
+  }
+  total_skipped = 0;
+  light_count = recount_lights();
 }
 
 // Load sample data
@@ -36,10 +155,11 @@ void load_sample() {
   for (r = 0; r < 6; ++r) {
     for (c = 0; c < 6; ++c) {
       if (sample_input[r][c] == '#') {
-        current_grid[r + 1][c + 1] = 1;
+        set_cell(r + 1, c + 1);
       }
     }
   }
+  setup_masks();
 }
 
 // Try to load input.txt
@@ -67,11 +187,11 @@ int load_file(const char *filename) {
       continue;
 
     if (grid_width == 0)
-      grid_width = len;
+      grid_width = len > MAX_SIZE ? MAX_SIZE : len;
 
-    for (c = 0; c < len; ++c) {
+    for (c = 0; c < grid_width && c < len; ++c) {
       if (buffer[c] == '#') {
-        current_grid[r][c + 1] = 1;
+        set_cell(r, c + 1);
       }
     }
     r++;
@@ -81,6 +201,7 @@ int load_file(const char *filename) {
   grid_height = r - 1;
 
   fclose(fp);
+  setup_masks();
   return 1;
 }
 
@@ -94,79 +215,213 @@ int setup_simulation(const char *input_file, int is_part2) {
   return 100;
 }
 
-// Count neighbors for cell at (r, c)
-// Because of sentinel borders, we don't need boundary checks!
-unsigned char count_neighbors(int r, int c) {
-  // 8 neighbors
-  // Top row
-  unsigned char count = current_grid[r - 1][c - 1] + current_grid[r - 1][c] +
-                        current_grid[r - 1][c + 1];
-  // Middle row (skip self)
-  count += current_grid[r][c - 1] + current_grid[r][c + 1];
-  // Bottom row
-  count += current_grid[r + 1][c - 1] + current_grid[r + 1][c] +
-           current_grid[r + 1][c + 1];
+// Full-adder sum of each cell with its left and right neighbours, for the
+// words flagged in 'dirty'. Because of sentinel words, neighbours across
+// word edges need no checks.
+void row_sum3(const lword *row, lword *lo, lword *hi,
+              const unsigned char *dirty) {
+  unsigned char i;
+  lword w, c, e;
 
-  return count;
+  for (i = 1; i <= row_words; ++i) {
+    if (!dirty[i])
+      continue;
+    c = row[i];
+    w = (lword)(c << 1) | (lword)(row[i - 1] >> (LWORD_BITS - 1));
+    e = (lword)(c >> 1) | (lword)(row[i + 1] << (LWORD_BITS - 1));
+    lo[i] = w ^ c ^ e;
+    hi[i] = (w & c) | (e & (w ^ c));
+  }
 }
 
 // Enforce corner lights ON (Part 2)
+void fix_corner(int r, int c) {
+  if (!get_cell(r, c)) {
+    set_cell(r, c);
+    ++light_count;
+  }
+}
+
 void fix_corners() {
-  current_grid[1][1] = 1;
-  current_grid[1][grid_width] = 1;
-  current_grid[grid_height][1] = 1;
-  current_grid[grid_height][grid_width] = 1;
+  fix_corner(1, 1);
+  fix_corner(1, grid_width);
+  fix_corner(grid_height, 1);
+  fix_corner(grid_height, grid_width);
 }
 
-// Run one simulation step
+// Run one simulation step.
+// Adding the 3-cell sums of three rows gives the 3x3 total including the
+// cell itself, as bits s0 + 2*s1 + 4*(t2 + t3). A cell is on next step if
+// the total is 3, or 4 and the cell is on now.
+// A skipped tile did not change last step, so the buffer being written
+// (the generation before last) already holds the same cells.
 void step_simulation(int fix_corners_mode) {
-  int r, c;
-
+  int r, r0, r1;
+  unsigned char tr, i, top, mid, bot, tmp, any;
+  lword a0, a1, b0, b1, c0, c1;
+  lword s0, s1, k0, t1, t2, t3, now, old;
+  const lword *force;
+  const unsigned char *dirty;
+  lword(*swap)[ROW_WORDS];
+
+  // Part 2 corners only change here before the first step; later steps
+  // force them on as they are computed
   if (fix_corners_mode) {
     fix_corners();
   }
 
-  for (r = 1; r <= grid_height; ++r) {
-    for (c = 1; c <= grid_width; ++c) {
-      unsigned char n = count_neighbors(r, c);
-      unsigned char state = current_grid[r][c];
-
-      next_grid[r][c] = (n == 3) || (state == 1 && n == 2);
+  for (tr = 1; tr <= tile_rows; ++tr) {
+    for (i = 1; i <= row_words; ++i) {
+      tile_dirty[tr][i] =
+          tile_changed[tr - 1][i - 1] | tile_changed[tr - 1][i] |
+          tile_changed[tr - 1][i + 1] | tile_changed[tr][i - 1] |
+          tile_changed[tr][i] | tile_changed[tr][i + 1] |
+          tile_changed[tr + 1][i - 1] | tile_changed[tr + 1][i] |
+          tile_changed[tr + 1][i + 1];
     }
   }
+  memset(tile_changed, 0, sizeof(tile_changed));
+  tiles_skipped = 0;
+
+  for (tr = 1; tr <= tile_rows; ++tr) {
+    dirty = tile_dirty[tr];
+    any = 0;
+    for (i = 1; i <= row_words; ++i) {
+      if (dirty[i]) {
+        any = 1;
+      } else {
+        ++tiles_skipped;
+      }
+    }
+    if (!any)
+      continue;
 
-  // Copy next to current
-  memcpy(current_grid, next_grid, sizeof(current_grid));
+    r0 = (tr - 1) * TILE_ROWS + 1;
+    r1 = r0 + TILE_ROWS - 1;
+    if (r1 > grid_height)
+      r1 = grid_height;
+
+    top = 0;
+    mid = 1;
+    bot = 2;
+    row_sum3(current_grid[r0 - 1], sum_lo[top], sum_hi[top], dirty);
+    row_sum3(current_grid[r0], sum_lo[mid], sum_hi[mid], dirty);
+
+    for (r = r0; r <= r1; ++r) {
+      row_sum3(current_grid[r + 1], sum_lo[bot], sum_hi[bot], dirty);
+      force = (fix_corners_mode && (r == 1 || r == grid_height)) ? corner_mask
+                                                                 : 0;
+
+      for (i = 1; i <= row_words; ++i) {
+        if (!dirty[i])
+          continue;
+        a0 = sum_lo[top][i];
+        a1 = sum_hi[top][i];
+        b0 = sum_lo[mid][i];
+        b1 = sum_hi[mid][i];
+        c0 = sum_lo[bot][i];
+        c1 = sum_hi[bot][i];
+
+        s0 = a0 ^ b0 ^ c0;
+        k0 = (a0 & b0) | (c0 & (a0 ^ b0));
+        t1 = a1 ^ b1 ^ c1;
+        t2 = (a1 & b1) | (c1 & (a1 ^ b1));
+        s1 = t1 ^ k0;
+        t3 = t1 & k0;
+
+        // total == 3: s0, s1 and no fours; total == 4: exactly one four
+        old = current_grid[r][i];
+        now = ((s0 & s1 & ~(t2 | t3)) | (old & ~(s0 | s1) & (t2 ^ t3))) &
+              edge_mask[i];
+        if (force) {
+          now |= force[i];
+        }
+        next_grid[r][i] = now;
+        if (now != old) {
+          tile_changed[tr][i] = 1;
+          light_count += count_bits(now) - count_bits(old);
+        }
+      }
 
-  if (fix_corners_mode) {
-    fix_corners();
+      tmp = top;
+      top = mid;
+      mid = bot;
+      bot = tmp;
+    }
   }
+  total_skipped += tiles_skipped;
+
+  // Swap next and current
+  swap = current_grid;
+  current_grid = next_grid;
+  next_grid = swap;
 }
 
-int count_lights() {
-  int count = 0;
-  int r, c;
-  for (r = 1; r <= grid_height; ++r) {
-    for (c = 1; c <= grid_width; ++c) {
-      if (current_grid[r][c])
-        count++;
+int count_lights() { return light_count; }
+
+#ifdef __CC65__
+// Each generation is animated on the hi-res screen, 2x2 pixels per light.
+// Only the tiles that changed in the last step are redrawn.
+static unsigned char render_left;
+
+void render_changed() {
+  int r, r0, r1;
+  unsigned char tr, i;
+
+  for (tr = 1; tr <= tile_rows; ++tr) {
+    r0 = (tr - 1) * TILE_ROWS + 1;
+    r1 = r0 + TILE_ROWS - 1;
+    if (r1 > grid_height)
+      r1 = grid_height;
+    for (i = 1; i <= row_words; ++i) {
+      if (!tile_changed[tr][i])
+        continue;
+      for (r = r0; r <= r1; ++r) {
+        vs_bitmap_cells(r - 1, render_left + i - 1, current_grid[r][i]);
+      }
     }
   }
-  return count;
 }
 
+// Show the starting grid (every tile is marked changed after loading)
+void animate_start() {
+  render_left = VS_BITMAP_CENTER(grid_width);
+  vs_bitmap_on(COLOR_YELLOW, COLOR_BLACK);
+  render_changed();
+}
+
+// Keep the last generation up until a key is pressed
+void animate_end() {
+  cgetc();
+  vs_bitmap_off();
+}
+#else
+#define animate_start()
+#define render_changed()
+#define animate_end()
+#endif
+
 void run_part1(const char *input_file) {
   int i;
   int steps;
   clock_t t0, t1;
+  long step_ticks = 0;
+  long render_ticks = 0;
 
   steps = setup_simulation(input_file, 0);
 
   printf("Running Part 1 (%d steps)...\n", steps);
-  t0 = clock();
+  animate_start();
 
+  // Engine and drawing are timed separately so the step time stays
+  // comparable with the non-animated engines
   for (i = 0; i < steps; ++i) {
+    t0 = clock();
     step_simulation(0);
+    t1 = clock();
+    render_changed();
+    step_ticks += (long)(t1 - t0);
+    render_ticks += (long)(clock() - t1);
     // specific optimization: print dot every 10 steps to show progress
     if (i % 10 == 0) {
       printf(".");
@@ -174,9 +429,11 @@ void run_part1(const char *input_file) {
   }
   printf("\n");
 
-  t1 = clock();
+  animate_end();
   printf("Part 1 Result: %d lights on\n", count_lights());
-  printf("Time: %ld ticks\n", (long)(t1 - t0));
+  printf("Time: %ld ticks (+%ld drawing)\n", step_ticks, render_ticks);
+  printf("Tiles skipped: %lu of %lu\n", total_skipped,
+         (unsigned long)tile_rows * row_words * steps);
 }
 
 void run_part2(const char *input_file) {
@@ -186,22 +443,128 @@ void run_part2(const char *input_file) {
   steps = setup_simulation(input_file, 1);
 
   printf("Running Part 2 (%d steps)...\n", steps);
+  animate_start();
 
   for (i = 0; i < steps; ++i) {
     step_simulation(1);
+    render_changed();
     if (i % 10 == 0)
       printf(".");
   }
   printf("\n");
+  animate_end();
 
   printf("Part 2 Result: %d lights on\n", count_lights());
 }
 
+#ifdef BENCHMARK
+// The original byte-per-cell engine, kept as a reference
+static unsigned char ref_grid[BUFFER_SIZE][BUFFER_SIZE];
+static unsigned char ref_next[BUFFER_SIZE][BUFFER_SIZE];
+
+void ref_step(int fix_corners_mode) {
+  int r, c;
+  unsigned char n;
+
+  if (fix_corners_mode) {
+    ref_grid[1][1] = ref_grid[1][grid_width] = 1;
+    ref_grid[grid_height][1] = ref_grid[grid_height][grid_width] = 1;
+  }
+  for (r = 1; r <= grid_height; ++r) {
+    for (c = 1; c <= grid_width; ++c) {
+      n = ref_grid[r - 1][c - 1] + ref_grid[r - 1][c] + ref_grid[r - 1][c + 1] +
+          ref_grid[r][c - 1] + ref_grid[r][c + 1] + ref_grid[r + 1][c - 1] +
+          ref_grid[r + 1][c] + ref_grid[r + 1][c + 1];
+      ref_next[r][c] = (n == 3) || (ref_grid[r][c] == 1 && n == 2);
+    }
+  }
+  memcpy(ref_grid, ref_next, sizeof(ref_grid));
+  if (fix_corners_mode) {
+    ref_grid[1][1] = ref_grid[1][grid_width] = 1;
+    ref_grid[grid_height][1] = ref_grid[grid_height][grid_width] = 1;
+  }
+}
+
+// Fill both engines with the same random 100x100 grid, 'percent' lit
+void load_random(unsigned long seed, int percent) {
+  int r, c;
+
+  grid_width = MAX_SIZE;
+  grid_height = MAX_SIZE;
+  clear_grids();
+  memset(ref_grid, 0, sizeof(ref_grid));
+  for (r = 1; r <= grid_height; ++r) {
+    for (c = 1; c <= grid_width; ++c) {
+      seed = seed * 1103515245UL + 12345UL;
+      if ((int)((seed >> 16) % 100) < percent) {
+        set_cell(r, c);
+        ref_grid[r][c] = 1;
+      }
+    }
+  }
+  setup_masks();
+}
+
+int grids_match() {
+  int r, c;
+  for (r = 1; r <= grid_height; ++r) {
+    for (c = 1; c <= grid_width; ++c) {
+      if (get_cell(r, c) != ref_grid[r][c]) {
+        return 0;
+      }
+    }
+  }
+  return 1;
+}
+
+void run_benchmark() {
+  int run, part, i, ok;
+  unsigned int skipped[100];
+  clock_t t0;
+  double t_ref, t_bits;
+
+  for (run = 0; run < 4; ++run) {
+    part = run & 1;
+    if (part == 0) {
+      printf("\nBenchmark: random 100x100, %d%% lit, 100 steps\n",
+             run < 2 ? 50 : 5);
+    }
+    load_random(18UL + run, run < 2 ? 50 : 5);
+    t0 = clock();
+    for (i = 0; i < 100; ++i) {
+      ref_step(part);
+    }
+    t_ref = (double)(clock() - t0) * 1000.0 / CLOCKS_PER_SEC;
+
+    t0 = clock();
+    for (i = 0; i < 100; ++i) {
+      step_simulation(part);
+      skipped[i] = tiles_skipped;
+    }
+    t_bits = (double)(clock() - t0) * 1000.0 / CLOCKS_PER_SEC;
+
+    ok = grids_match() && count_lights() == recount_lights();
+    printf("Part %d: %d lights, bytes %.2f ms, bits %.2f ms (%s)\n", part + 1,
+           count_lights(), t_ref, t_bits, ok ? "match" : "MISMATCH");
+    printf("Tiles skipped per step (of %d):", tile_rows * row_words);
+    for (i = 0; i < 100; i += 10) {
+      printf(" %u", skipped[i]);
+    }
+    printf(" ... %u\n", skipped[99]);
+  }
+}
+#endif
+
 int main() {
   printf("AoC 2015 - Day 18\n");
 
+  setup_bit_count();
   run_part1("input.txt");
   run_part2("input.txt");
 
+#ifdef BENCHMARK
+  run_benchmark();
+#endif
+
   return 0;
 }
@@ -2,15 +2,46 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
 
-/* Scaled down for C64 performance demonstration */
+/* Small goal: per-house trial division and the sieve must agree */
 #define MIN_PRESENTS_GOAL 50000L
 
+/* A real puzzle goal, only practical with the sieve */
+#define REAL_PRESENTS_GOAL 33100000L
+
+/* Part 2: each elf stops after this many houses */
+#define PART2_HOUSES 50
+
+/* Sieve block: as many houses as free RAM allows, within these limits */
+#define MIN_BLOCK 256
+#define MAX_BLOCK 16384
+#define HEAP_RESERVE 512
+
+/*
+ * Smallest-prime-factor table for the SPF engine, one byte per house.
+ * Below 65536 every composite has a prime factor <= 251, so 0 can mean
+ * "prime" and the table never needs 16-bit entries.
+ */
+#define SPF_LIMIT 16384
+
 /* Function Prototypes */
 typedef unsigned long (*calc_func)(unsigned long);
 unsigned long calculate_presents_part1(unsigned long house);
 unsigned long calculate_presents_part2(unsigned long house);
+unsigned long calculate_presents_part1_spf(unsigned long house);
+unsigned char build_spf_table(void);
 void solve(const char *part_name, calc_func calculate);
+unsigned char alloc_block(void);
+void solve_sieve(const char *part_name, unsigned char part2,
+                 unsigned long goal);
+
+/* spf[n]: smallest prime factor of n, or 0 if n is prime */
+unsigned char *spf;
+
+/* Per-house divisor sums (without the 10x / 11x factor) for one block */
+unsigned long *block;
+unsigned int block_size;
 
 int main(void) {
   bgcolor(COLOR_BLUE);
@@ -20,14 +51,34 @@ int main(void) {
   gotoxy(0, 0);
 
   cprintf("ADVENT OF CODE 2015 - DAY 20\r\n");
-  cprintf("INFINITE ELVES & HOUSES (LITE)\r\n");
+  cprintf("INFINITE ELVES & HOUSES\r\n");
   cprintf("==============================\r\n");
   cprintf("TARGET: %lu PRESENTS\r\n\r\n", MIN_PRESENTS_GOAL);
 
   solve("PART 1", calculate_presents_part1);
+  if (build_spf_table()) {
+    solve("PART 1 SPF", calculate_presents_part1_spf);
+    free(spf);
+  } else {
+    cprintf("NO MEMORY FOR THE SPF TABLE.\r\n");
+  }
   cprintf("\r\n");
   solve("PART 2", calculate_presents_part2);
 
+  if (!alloc_block()) {
+    cprintf("\r\nNOT ENOUGH MEMORY FOR THE SIEVE.\r\n");
+    cgetc();
+    return 1;
+  }
+  cprintf("\r\nSIEVE BLOCK: %u HOUSES\r\n", block_size);
+  solve_sieve("PART 1", 0, MIN_PRESENTS_GOAL);
+  solve_sieve("PART 2", 1, MIN_PRESENTS_GOAL);
+
+  cprintf("\r\nREAL TARGET: %lu PRESENTS\r\n", REAL_PRESENTS_GOAL);
+  solve_sieve("PART 1", 0, REAL_PRESENTS_GOAL);
+  solve_sieve("PART 2", 1, REAL_PRESENTS_GOAL);
+  free(block);
+
   cprintf("\r\nPRESS ANY KEY TO EXIT.\r\n");
   cgetc();
 
@@ -37,6 +88,7 @@ int main(void) {
 void solve(const char *part_name, calc_func calculate) {
   unsigned long house = 1;
   unsigned long presents;
+  clock_t start = clock();
 
   cprintf("SOLVING %s...\r\n", part_name);
   for (house = 1;; ++house) {
@@ -47,6 +99,7 @@ void solve(const char *part_name, calc_func calculate) {
       cprintf(".");
   }
   cprintf("\r\n%s: HOUSE %lu (%lu PRESENTS)\r\n", part_name, house, presents);
+  cprintf("TIME: %lu TICKS\r\n", (unsigned long)(clock() - start));
 }
 
 /*
@@ -66,6 +119,58 @@ unsigned long calculate_presents_part1(unsigned long house) {
   return sum * 10;
 }
 
+/*
+ * Sieve of Eratosthenes recording the smallest prime factor of each
+ * composite below SPF_LIMIT. Returns 0 if the table cannot be allocated.
+ */
+unsigned char build_spf_table(void) {
+  unsigned int p, m;
+
+  spf = (unsigned char *)malloc(SPF_LIMIT);
+  if (spf == NULL)
+    return 0;
+  memset(spf, 0, SPF_LIMIT);
+  for (p = 2; p * p < SPF_LIMIT; ++p) {
+    if (spf[p])
+      continue;
+    for (m = p * p; m < SPF_LIMIT; m += p) {
+      if (!spf[m])
+        spf[m] = (unsigned char)p;
+    }
+  }
+  return 1;
+}
+
+/*
+ * Same result as calculate_presents_part1, via the multiplicative
+ * property: sigma(p1^a1 * ... * pk^ak) = prod (1 + pi + ... + pi^ai).
+ * Peeling primes off with the table takes O(log n) 16-bit divisions
+ * instead of O(sqrt n) 32-bit ones. Houses past the table fall back to
+ * trial division.
+ */
+unsigned long calculate_presents_part1_spf(unsigned long house) {
+  unsigned long sum = 1;
+  unsigned long term, power;
+  unsigned int n, p;
+
+  if (house >= SPF_LIMIT)
+    return calculate_presents_part1(house);
+
+  n = (unsigned int)house;
+  while (n > 1) {
+    p = spf[n] ? spf[n] : n;
+    term = 1;
+    power = 1;
+    do {
+      n /= p;
+      power *= p;
+      term += power;
+    } while (n % p == 0);
+    sum *= term;
+  }
+  return sum * 10;
+}
+
 /*
  * Each elf 'i' delivers 11*i presents to 50 houses.
  * For house 'H', we sum 11*i for divisors 'i' where H/i <= 50.
@@ -89,3 +194,89 @@ unsigned long calculate_presents_part2(unsigned long house) {
   }
   return sum * 11;
 }
+
+/*
+ * Take the largest block of houses that fits in free RAM.
+ * Returns 0 if not even MIN_BLOCK houses fit.
+ */
+unsigned char alloc_block(void) {
+  unsigned long bytes;
+
+#ifdef __CC65__
+  bytes = _heapmaxavail();
+  bytes = bytes > HEAP_RESERVE ? bytes - HEAP_RESERVE : 0;
+#else
+  bytes = MAX_BLOCK * sizeof(unsigned long);
+#endif
+  bytes /= sizeof(unsigned long);
+  if (bytes > MAX_BLOCK)
+    bytes = MAX_BLOCK;
+  if (bytes < MIN_BLOCK)
+    return 0;
+
+  block_size = (unsigned int)bytes;
+  block = (unsigned long *)malloc(block_size * sizeof(unsigned long));
+  return block != NULL;
+}
+
+/*
+ * Segmented divisor-sum sieve over blocks [lo, lo + block_size).
+ *
+ * Part 1: every divisor pair (d, k) of a house h = d * k with d <= k is
+ * added once from the smaller side, so a block costs sqrt(hi) setups plus
+ * about block_size * ln(sqrt(hi)) additions, not one pass per elf.
+ * Part 2: elf e = h / k only visits houses with k <= PART2_HOUSES, so the
+ * block is filled by walking k = 1..50 instead of the elves.
+ */
+void solve_sieve(const char *part_name, unsigned char part2,
+                 unsigned long goal) {
+  unsigned char per_elf = part2 ? 11 : 10;
+  unsigned long need = (goal + per_elf - 1) / per_elf;
+  unsigned long lo, hi, first, d, k;
+  unsigned long best = 0;
+  unsigned int idx, step, segment = 0;
+
+  cprintf("SIEVING %s...\r\n", part_name);
+  for (lo = 1;; lo = hi) {
+    hi = lo + block_size;
+    memset(block, 0, block_size * sizeof(unsigned long));
+
+    if (!part2) {
+      for (d = 1; d * d < hi; ++d) {
+        /* first multiple of d in the block with cofactor k >= d */
+        first = d * d;
+        if (first < lo)
+          first = (lo + d - 1) / d * d;
+        k = first / d;
+        step = (unsigned int)d;
+        for (idx = (unsigned int)(first - lo); idx < block_size;
+             idx += step, ++k) {
+          block[idx] += (k == d) ? d : d + k;
+        }
+      }
+    } else {
+      for (k = 1; k <= PART2_HOUSES; ++k) {
+        first = (lo + k - 1) / k * k;
+        d = first / k; /* elf number */
+        step = (unsigned int)k;
+        for (idx = (unsigned int)(first - lo); idx < block_size;
+             idx += step, ++d) {
+          block[idx] += d;
+        }
+      }
+    }
+
+    ++segment;
+    for (idx = 0; idx < block_size; ++idx) {
+      if (block[idx] >= need) {
+        cprintf("\r\n%s: HOUSE %lu (%lu PRESENTS)\r\n", part_name,
+                lo + idx, block[idx] * per_elf);
+        return;
+      }
+      if (block[idx] > best)
+        best = block[idx];
+    }
+    cprintf("\rBLOCK %u TO %lu, BEST %lu   ", segment, hi - 1,
+            best * per_elf);
+  }
+}
@@ -3,33 +3,81 @@
 #include <stdlib.h>
 #include <string.h>
 
+#define SHOP_FILE "shop.txt"
+#define PLAYER_HP 100
+
+#define MAX_ITEMS 12      /* per shop section */
+#define ITEM_NAME_LEN 12
+#define MAX_LOADOUTS 1024 /* 8 bytes each */
+#define MAX_STAT 32       /* damage / armor totals must stay below this */
+#define NO_ITEM 0xFF
+
 /* Item structure */
 typedef struct {
-  const char *name;
+  char name[ITEM_NAME_LEN];
   unsigned int cost;
   unsigned char damage;
   unsigned char armor;
 } Item;
 
+/* One legal equipment set: 1 weapon, 0-1 armor, 0-2 different rings */
+typedef struct {
+  unsigned int cost;
+  unsigned char damage;
+  unsigned char armor;
+  unsigned char weapon;
+  unsigned char armor_item; /* NO_ITEM if none */
+  unsigned char ring1;      /* NO_ITEM if none */
+  unsigned char ring2;      /* NO_ITEM if none */
+} Loadout;
+
+/* Built-in shop, used when SHOP_FILE is missing */
+const Item default_weapons[] = {{"Dagger", 8, 4, 0},
+                                {"Shortsword", 10, 5, 0},
+                                {"Warhammer", 25, 6, 0},
+                                {"Longsword", 40, 7, 0},
+                                {"Greataxe", 74, 8, 0}};
+
+const Item default_armor[] = {{"Leather", 13, 0, 1},
+                              {"Chainmail", 31, 0, 2},
+                              {"Splintmail", 53, 0, 3},
+                              {"Bandedmail", 75, 0, 4},
+                              {"Platemail", 102, 0, 5}};
+
+const Item default_rings[] = {{"Damage +1", 25, 1, 0},  {"Damage +2", 50, 2, 0},
+                              {"Damage +3", 100, 3, 0}, {"Defense +1", 20, 0, 1},
+                              {"Defense +2", 40, 0, 2}, {"Defense +3", 80, 0, 3}};
+
+/* Shop sections */
+#define SECTION_NONE 0
+#define SECTION_WEAPONS 1
+#define SECTION_ARMOR 2
+#define SECTION_RINGS 3
+
 /* Item Tables */
-const Item weapons[] = {{"Dagger", 8, 4, 0},
-                        {"Shortsword", 10, 5, 0},
-                        {"Warhammer", 25, 6, 0},
-                        {"Longsword", 40, 7, 0},
-                        {"Greataxe", 74, 8, 0}};
+Item weapons[MAX_ITEMS];
+Item armors[MAX_ITEMS];
+Item rings[MAX_ITEMS];
+unsigned char weapon_count, armor_count, ring_count;
 
-const Item armor[] = {{"None", 0, 0, 0},        {"Leather", 13, 0, 1},
-                      {"Chainmail", 31, 0, 2},  {"Splintmail", 53, 0, 3},
-                      {"Bandedmail", 75, 0, 4}, {"Platemail", 102, 0, 5}};
+/* All loadouts sorted by cost, and the non-dominated ones per part */
+Loadout loadouts[MAX_LOADOUTS];
+unsigned int loadout_count;
+unsigned char loadouts_dropped;
+unsigned int win_list[MAX_LOADOUTS];  /* ascending cost */
+unsigned int lose_list[MAX_LOADOUTS]; /* descending cost */
+unsigned int win_count, lose_count;
 
-const Item rings[] = {{"None 1", 0, 0, 0},      {"None 2", 0, 0, 0},
-                      {"Damage +1", 25, 1, 0},  {"Damage +2", 50, 2, 0},
-                      {"Damage +3", 100, 3, 0}, {"Defense +1", 20, 0, 1},
-                      {"Defense +2", 40, 0, 2}, {"Defense +3", 80, 0, 3}};
+/*
+ * covered[d] bit a: some loadout already seen reaches (d, a) or better
+ * (part 1), or (d, a) or worse (part 2).
+ */
+unsigned long covered[MAX_STAT];
+unsigned long bit32[MAX_STAT];
 
-#define WEAPON_COUNT (sizeof(weapons) / sizeof(weapons[0]))
-#define ARMOR_COUNT (sizeof(armor) / sizeof(armor[0]))
-#define RING_COUNT (sizeof(rings) / sizeof(rings[0]))
+/* min_armor[d]: least armor that beats the boss with damage d */
+unsigned char min_armor[MAX_STAT];
+unsigned int battles;
 
 /* Boss Stats (Configurable) */
 typedef struct {
@@ -45,6 +93,7 @@ int simulate_battle(int player_hp, int player_dmg, int player_arm,
   int b_dmg_done = boss->damage - player_arm;
   int player_turns, boss_turns;
 
+  ++battles;
   if (p_dmg_done < 1)
     p_dmg_done = 1;
   if (b_dmg_done < 1)
@@ -58,10 +107,351 @@ int simulate_battle(int player_hp, int player_dmg, int player_arm,
   return player_turns <= boss_turns;
 }
 
+#define IS_BLANK(c) ((c) == ' ' || (c) == '\t')
+
+/* Cut the last whitespace-separated number off 'line' and return it */
+unsigned int take_number(char *line) {
+  int end = strlen(line);
+  int start;
+  unsigned int value;
+
+  while (end > 0 && IS_BLANK(line[end - 1]))
+    --end;
+  start = end;
+  while (start > 0 && !IS_BLANK(line[start - 1]))
+    --start;
+  line[end] = 0;
+  value = (unsigned int)atoi(line + start);
+  line[start] = 0;
+  return value;
+}
+
+/*
+ * Read a shop in the puzzle's format: "Weapons:", "Armor:" and "Rings:"
+ * headers, then one item per line ending in cost, damage and armor. Names
+ * may contain spaces ("Damage +1"). Returns 0 if the file cannot be opened
+ * and -1 if a section has more than MAX_ITEMS items.
+ */
+int load_shop(const char *filename) {
+  FILE *fp;
+  char buffer[64];
+  unsigned char section = SECTION_NONE;
+  unsigned char *count;
+  Item *table;
+  Item *item;
+  int len;
+
+  fp = fopen(filename, "r");
+  if (!fp) {
+    return 0;
+  }
+
+  weapon_count = armor_count = ring_count = 0;
+  while (fgets(buffer, sizeof(buffer), fp)) {
+    len = strlen(buffer);
+    /* Trim newline */
+    while (len > 0 && (buffer[len - 1] == '\r' || buffer[len - 1] == '\n')) {
+      buffer[--len] = 0;
+    }
+    if (len == 0)
+      continue;
+
+    if (strchr(buffer, ':')) {
+      if (strncmp(buffer, "Weapons", 7) == 0)
+        section = SECTION_WEAPONS;
+      else if (strncmp(buffer, "Armor", 5) == 0)
+        section = SECTION_ARMOR;
+      else if (strncmp(buffer, "Rings", 5) == 0)
+        section = SECTION_RINGS;
+      else
+        section = SECTION_NONE;
+      continue;
+    }
+
+    if (section == SECTION_WEAPONS) {
+      table = weapons;
+      count = &weapon_count;
+    } else if (section == SECTION_ARMOR) {
+      table = armors;
+      count = &armor_count;
+    } else if (section == SECTION_RINGS) {
+      table = rings;
+      count = &ring_count;
+    } else {
+      continue;
+    }
+    if (*count >= MAX_ITEMS) {
+      cprintf("Shop: more than %d items in a section\r\n", MAX_ITEMS);
+      fclose(fp);
+      return -1;
+    }
+
+    item = &table[(*count)++];
+    item->armor = (unsigned char)take_number(buffer);
+    item->damage = (unsigned char)take_number(buffer);
+    item->cost = take_number(buffer);
+    len = strlen(buffer);
+    while (len > 0 && IS_BLANK(buffer[len - 1]))
+      buffer[--len] = 0;
+    strncpy(item->name, buffer, ITEM_NAME_LEN - 1);
+    item->name[ITEM_NAME_LEN - 1] = '\0';
+  }
+
+  fclose(fp);
+  return 1;
+}
+
+void load_default_shop(void) {
+  weapon_count = sizeof(default_weapons) / sizeof(default_weapons[0]);
+  armor_count = sizeof(default_armor) / sizeof(default_armor[0]);
+  ring_count = sizeof(default_rings) / sizeof(default_rings[0]);
+  memcpy(weapons, default_weapons, sizeof(default_weapons));
+  memcpy(armors, default_armor, sizeof(default_armor));
+  memcpy(rings, default_rings, sizeof(default_rings));
+}
+
+unsigned char item_stat(const Item *item, unsigned char armor) {
+  return armor ? item->armor : item->damage;
+}
+
+/* Largest damage (armor = 0) or armor (armor = 1) a loadout can reach */
+unsigned int best_total(unsigned char armor) {
+  unsigned int weapon = 0, armor_item = 0, ring1 = 0, ring2 = 0, v;
+  unsigned char i;
+
+  for (i = 0; i < weapon_count; ++i) {
+    v = item_stat(&weapons[i], armor);
+    if (v > weapon)
+      weapon = v;
+  }
+  for (i = 0; i < armor_count; ++i) {
+    v = item_stat(&armors[i], armor);
+    if (v > armor_item)
+      armor_item = v;
+  }
+  for (i = 0; i < ring_count; ++i) {
+    v = item_stat(&rings[i], armor);
+    if (v > ring1) {
+      ring2 = ring1;
+      ring1 = v;
+    } else if (v > ring2) {
+      ring2 = v;
+    }
+  }
+  return weapon + armor_item + ring1 + ring2;
+}
+
+/*
+ * Every loadout must fit the table and the MAX_STAT bitsets, or the
+ * answers could silently miss one. Checked before anything is built.
+ */
+unsigned char shop_fits(void) {
+  unsigned long total;
+
+  total = (unsigned long)weapon_count * (armor_count + 1) *
+          (1 + ring_count + ring_count * (ring_count - 1) / 2);
+  if (total > MAX_LOADOUTS) {
+    cprintf("Shop has %lu loadouts, max %d\r\n", total, MAX_LOADOUTS);
+    return 0;
+  }
+  if (best_total(0) >= MAX_STAT || best_total(1) >= MAX_STAT) {
+    cprintf("Shop: damage or armor can reach %d\r\n", MAX_STAT);
+    return 0;
+  }
+  return 1;
+}
+
+/* Append one loadout; items are indices or NO_ITEM */
+void add_loadout(unsigned char w, unsigned char a, unsigned char r1,
+                 unsigned char r2) {
+  Loadout *l;
+  unsigned int damage = weapons[w].damage;
+  unsigned int arm = weapons[w].armor;
+  unsigned int cost = weapons[w].cost;
+
+  if (a != NO_ITEM) {
+    cost += armors[a].cost;
+    damage += armors[a].damage;
+    arm += armors[a].armor;
+  }
+  if (r1 != NO_ITEM) {
+    cost += rings[r1].cost;
+    damage += rings[r1].damage;
+    arm += rings[r1].armor;
+  }
+  if (r2 != NO_ITEM) {
+    cost += rings[r2].cost;
+    damage += rings[r2].damage;
+    arm += rings[r2].armor;
+  }
+
+  if (loadout_count >= MAX_LOADOUTS || damage >= MAX_STAT ||
+      arm >= MAX_STAT) {
+    loadouts_dropped = 1;
+    return;
+  }
+  l = &loadouts[loadout_count++];
+  l->cost = cost;
+  l->damage = (unsigned char)damage;
+  l->armor = (unsigned char)arm;
+  l->weapon = w;
+  l->armor_item = a;
+  l->ring1 = r1;
+  l->ring2 = r2;
+}
+
+int compare_cost(const void *a, const void *b) {
+  unsigned int ca = ((const Loadout *)a)->cost;
+  unsigned int cb = ((const Loadout *)b)->cost;
+  return (ca > cb) - (ca < cb);
+}
+
+/* Every legal loadout, sorted by cost */
+void build_loadouts(void) {
+  unsigned char w, a, armor_item, r1, r2;
+
+  loadout_count = 0;
+  loadouts_dropped = 0;
+  for (w = 0; w < weapon_count; ++w) {
+    for (a = 0; a <= armor_count; ++a) {
+      armor_item = (a == armor_count) ? NO_ITEM : a;
+      add_loadout(w, armor_item, NO_ITEM, NO_ITEM);
+      for (r1 = 0; r1 < ring_count; ++r1) {
+        add_loadout(w, armor_item, r1, NO_ITEM);
+        for (r2 = r1 + 1; r2 < ring_count; ++r2) {
+          add_loadout(w, armor_item, r1, r2);
+        }
+      }
+    }
+  }
+  qsort(loadouts, loadout_count, sizeof(Loadout), compare_cost);
+}
+
+/*
+ * Drop dominated loadouts. For winning, a loadout is useless if one that
+ * costs no more has at least its damage and armor; for losing, if one
+ * that costs no less has at most its damage and armor. covered[] keeps,
+ * per damage value, a bitset of the armor values already dominated.
+ */
+void prune_loadouts(void) {
+  unsigned int i;
+  unsigned char d;
+  unsigned long below;
+  const Loadout *l;
+
+  for (d = 0; d < MAX_STAT; ++d)
+    bit32[d] = d ? bit32[d - 1] << 1 : 1UL;
+
+  memset(covered, 0, sizeof(covered));
+  win_count = 0;
+  for (i = 0; i < loadout_count; ++i) {
+    l = &loadouts[i];
+    if (covered[l->damage] & bit32[l->armor])
+      continue;
+    win_list[win_count++] = i;
+    below = bit32[l->armor] | (bit32[l->armor] - 1); /* armor 0..a */
+    for (d = 0; d <= l->damage; ++d)
+      covered[d] |= below;
+  }
+
+  memset(covered, 0, sizeof(covered));
+  lose_count = 0;
+  for (i = loadout_count; i-- > 0;) {
+    l = &loadouts[i];
+    if (covered[l->damage] & bit32[l->armor])
+      continue;
+    lose_list[lose_count++] = i;
+    below = ~(bit32[l->armor] - 1); /* armor a..31 */
+    for (d = l->damage; d < MAX_STAT; ++d)
+      covered[d] |= below;
+  }
+}
+
+/*
+ * More armor never hurts, so for each damage value the winning armor
+ * values form a suffix. Binary-search its start with simulate_battle;
+ * MAX_STAT means the damage can never win.
+ */
+void find_min_armor(const Character *boss) {
+  unsigned char d, lo, hi, mid;
+
+  battles = 0;
+  for (d = 0; d < MAX_STAT; ++d) {
+    lo = 0;
+    hi = MAX_STAT;
+    while (lo < hi) {
+      mid = (lo + hi) >> 1;
+      if (simulate_battle(PLAYER_HP, d, mid, boss))
+        hi = mid;
+      else
+        lo = mid + 1;
+    }
+    min_armor[d] = lo;
+  }
+}
+
+void print_loadout(const Loadout *l) {
+  cprintf("  %s", weapons[l->weapon].name);
+  if (l->armor_item != NO_ITEM)
+    cprintf(", %s", armors[l->armor_item].name);
+  if (l->ring1 != NO_ITEM)
+    cprintf(", %s", rings[l->ring1].name);
+  if (l->ring2 != NO_ITEM)
+    cprintf(", %s", rings[l->ring2].name);
+  cprintf("\r\n");
+}
+
+/* Build, prune and search the loadouts of the loaded shop */
+void solve_shop(const Character *boss) {
+  unsigned int i;
+  const Loadout *l;
+  const Loadout *cheapest_win = NULL;
+  const Loadout *priciest_loss = NULL;
+
+  build_loadouts();
+  prune_loadouts();
+  find_min_armor(boss);
+  cprintf("Loadouts: %u, kept %u win / %u lose\r\n", loadout_count,
+          win_count, lose_count);
+  cprintf("Battles simulated: %u\r\n", battles);
+  if (loadouts_dropped) {
+    /* shop_fits should rule this out; a partial table proves nothing */
+    cprintf("Some loadouts did not fit: no answers\r\n");
+    return;
+  }
+
+  for (i = 0; i < win_count; ++i) {
+    l = &loadouts[win_list[i]];
+    if (l->armor >= min_armor[l->damage]) {
+      cheapest_win = l;
+      break;
+    }
+  }
+  for (i = 0; i < lose_count; ++i) {
+    l = &loadouts[lose_list[i]];
+    if (l->armor < min_armor[l->damage]) {
+      priciest_loss = l;
+      break;
+    }
+  }
+
+  cprintf("\r\nResults:\r\n");
+  if (cheapest_win) {
+    cprintf("Part 1 (Min Gold to Win): %u\r\n", cheapest_win->cost);
+    print_loadout(cheapest_win);
+  } else {
+    cprintf("Part 1: no loadout wins\r\n");
+  }
+  if (priciest_loss) {
+    cprintf("Part 2 (Max Gold to Lose): %u\r\n", priciest_loss->cost);
+    print_loadout(priciest_loss);
+  } else {
+    cprintf("Part 2: no loadout loses\r\n");
+  }
+}
+
 void main(void) {
-  unsigned int min_gold = 65535U;
-  unsigned int max_gold = 0;
-  unsigned char w, a, r1, r2;
+  int loaded;
   Character boss = {104, 8, 1}; /* Example/Estimated stats */
 
   bgcolor(COLOR_BLACK);
@@ -73,34 +463,26 @@ void main(void) {
   cprintf("RPG Simulator 20XX - Day 21\r\n");
   cprintf("---------------------------\r\n");
   cprintf("Boss: HP=%d Dmg=%d Arm=%d\r\n", boss.hp, boss.damage, boss.armor);
-  cprintf("Simulating combinations...\r\n");
-
-  for (w = 0; w < WEAPON_COUNT; ++w) {
-    for (a = 0; a < ARMOR_COUNT; ++a) {
-      for (r1 = 0; r1 < RING_COUNT; ++r1) {
-        for (r2 = r1 + 1; r2 < RING_COUNT; ++r2) {
-          unsigned int cost =
-              weapons[w].cost + armor[a].cost + rings[r1].cost + rings[r2].cost;
-          unsigned char p_dmg = weapons[w].damage + armor[a].damage +
-                                rings[r1].damage + rings[r2].damage;
-          unsigned char p_arm = weapons[w].armor + armor[a].armor +
-                                rings[r1].armor + rings[r2].armor;
-
-          if (simulate_battle(100, p_dmg, p_arm, &boss)) {
-            if (cost < min_gold)
-              min_gold = cost;
-          } else {
-            if (cost > max_gold)
-              max_gold = cost;
-          }
-        }
-      }
-    }
+
+  loaded = load_shop(SHOP_FILE);
+  if (loaded > 0) {
+    cprintf("Shop loaded from %s\r\n", SHOP_FILE);
+  } else if (loaded == 0) {
+    load_default_shop();
+    cprintf("Using built-in shop\r\n");
   }
 
-  cprintf("\r\nResults:\r\n");
-  cprintf("Part 1 (Min Gold to Win): %u\r\n", min_gold);
-  cprintf("Part 2 (Max Gold to Lose): %u\r\n", max_gold);
+  if (loaded >= 0) {
+    cprintf("Items: %d weapons, %d armor, %d rings\r\n", weapon_count,
+            armor_count, ring_count);
+    if (shop_fits()) {
+      solve_shop(&boss);
+    } else {
+      cprintf("Shop too large: no answers\r\n");
+    }
+  } else {
+    cprintf("Shop not usable: no answers\r\n");
+  }
 
   cprintf("\r\nPress any key to exit.");
   cgetc();
@@ -52,26 +52,61 @@ const Spell spell_data[] = {
     {COST_POISON, 0, 0, 0, POISON_DURATION, 0},
     {COST_RECHARGE, 0, 0, 0, 0, RECHARGE_DURATION}};
 
+/* Search strategies; STRATEGY picks which ones main runs */
+#define STRATEGY_DFS 1
+#define STRATEGY_UCS 2
+#ifndef STRATEGY
+#define STRATEGY (STRATEGY_DFS | STRATEGY_UCS)
+#endif
+
+/* Outcome of one player cast plus the boss turn that follows */
+#define ROUND_ONGOING 0
+#define ROUND_WON 1
+#define ROUND_LOST 2
+
+#define PROGRESS_ROW 16
+
 unsigned long states_count = 0;
 unsigned int min_mana = 0xFFFF;
 unsigned char hard_mode = 0;
 
-/* Simple memoization to avoid redundant work */
-#define CACHE_SIZE 128
+/* Transposition table: TT_SETS sets of TT_WAYS entries, keyed by the
+ * full state at the start of a player turn. Each entry keeps the least
+ * mana spent to reach that state; arriving again with as much or more
+ * cannot do better. */
+#define TT_SETS 256
+#define TT_WAYS 4
+#define TT_VALID 0x8000
 typedef struct {
   signed char hp, boss_hp;
-  unsigned char s, p, r;
-  unsigned char valid;
-} StateKey;
-unsigned int cache_mana[CACHE_SIZE];
-StateKey cache_key[CACHE_SIZE];
+  int mana;
+  unsigned int timers; /* shield | poison << 3 | recharge << 6 | hard << 9 */
+  unsigned int best_spent;
+} TTEntry;
+TTEntry tt[TT_SETS][TT_WAYS];
+unsigned long tt_hits;
+unsigned long tt_misses;
+
+/* Uniform-cost search frontier: a binary min-heap on mana spent of
+ * 8-byte packed states */
+#define HEAP_SIZE 2048
+typedef struct {
+  unsigned int spent;
+  int mana;
+  signed char hp, boss_hp;
+  unsigned char effects; /* shield | poison << 4 */
+  unsigned char recharge;
+} PackedState;
+PackedState heap[HEAP_SIZE];
+unsigned int heap_len;
+unsigned int heap_peak;
 
 void update_progress() {
   unsigned char x = wherex();
   unsigned char y = wherey();
-  gotoxy(0, 12);
+  gotoxy(0, PROGRESS_ROW);
   textcolor(COLOR_LIGHTBLUE);
-  cprintf("states: %lu    ", states_count);
+  cprintf("states: %lu  tt hits: %lu    ", states_count, tt_hits);
   textcolor(COLOR_WHITE);
   gotoxy(x, y);
 }
@@ -92,16 +127,142 @@ void apply_effects(GameState *s, signed char *armor) {
   }
 }
 
+void tt_clear(void) {
+  memset(tt, 0, sizeof(tt));
+  tt_hits = 0;
+  tt_misses = 0;
+}
+
+/* Returns 1 if the state was already reached at no greater cost.
+ * Otherwise records it, evicting the way with the highest cost (the
+ * weakest cutoff) when the set is full. */
+unsigned char tt_probe(const GameState *s) {
+  unsigned int timers;
+  unsigned char h, w;
+  TTEntry *set;
+  TTEntry *e;
+  TTEntry *victim;
+
+  timers = s->shield_timer | (s->poison_timer << 3) |
+           (s->recharge_timer << 6) | ((unsigned int)hard_mode << 9) |
+           TT_VALID;
+  h = (unsigned char)s->player_hp ^ ((unsigned char)s->boss_hp << 2) ^
+      (unsigned char)s->player_mana ^
+      ((unsigned char)(s->player_mana >> 8) << 5) ^ (unsigned char)timers ^
+      (unsigned char)(timers >> 3);
+  set = tt[h];
+  victim = 0;
+
+  for (w = 0; w < TT_WAYS; ++w) {
+    e = &set[w];
+    if (e->timers == timers && e->hp == s->player_hp &&
+        e->boss_hp == s->boss_hp && e->mana == s->player_mana) {
+      if ((unsigned int)s->mana_spent >= e->best_spent) {
+        ++tt_hits;
+        return 1;
+      }
+      e->best_spent = s->mana_spent;
+      ++tt_misses;
+      return 0;
+    }
+    if (!(e->timers & TT_VALID)) {
+      if (!victim || (victim->timers & TT_VALID))
+        victim = e;
+    } else if (!victim || ((victim->timers & TT_VALID) &&
+                           e->best_spent > victim->best_spent)) {
+      victim = e;
+    }
+  }
+
+  ++tt_misses;
+  victim->hp = s->player_hp;
+  victim->boss_hp = s->boss_hp;
+  victim->mana = s->player_mana;
+  victim->timers = timers;
+  victim->best_spent = s->mana_spent;
+  return 0;
+}
+
+/* Lower bound on the mana still needed to win. Damage from an active
+ * poison is already paid for; the rest costs at least 9 mana per HP
+ * (poison, the cheapest spell per damage, is 173 for 18). */
+int mana_needed(const GameState *s) {
+  int hp = s->boss_hp - s->poison_timer * POISON_DAMAGE;
+  return hp > 0 ? hp * 9 : 0;
+}
+
+/* Start of the player turn: hard mode drain, then effects */
+unsigned char start_turn(GameState *s) {
+  signed char armor;
+
+  if (hard_mode) {
+    s->player_hp--;
+    if (s->player_hp <= 0)
+      return ROUND_LOST;
+  }
+  apply_effects(s, &armor);
+  return s->boss_hp <= 0 ? ROUND_WON : ROUND_ONGOING;
+}
+
+unsigned char can_cast(const GameState *s, const Spell *sd) {
+  if (s->player_mana < (int)sd->cost)
+    return 0;
+  if (sd->shield_t && s->shield_timer > 0)
+    return 0;
+  if (sd->poison_t && s->poison_timer > 0)
+    return 0;
+  if (sd->recharge_t && s->recharge_timer > 0)
+    return 0;
+  return 1;
+}
+
+/* Cast sd on next (a copy of the state after start_turn), then play the
+ * boss turn */
+unsigned char play_round(GameState *next, const Spell *sd) {
+  signed char player_armor;
+  signed char dmg;
+
+  next->player_mana -= sd->cost;
+  next->mana_spent += sd->cost;
+
+  /* Immediate effects */
+  next->boss_hp -= sd->damage;
+  next->player_hp += sd->heal;
+
+  /* Over-time effects */
+  if (sd->shield_t)
+    next->shield_timer = sd->shield_t;
+  if (sd->poison_t)
+    next->poison_timer = sd->poison_t;
+  if (sd->recharge_t)
+    next->recharge_timer = sd->recharge_t;
+
+  if (next->boss_hp <= 0)
+    return ROUND_WON;
+
+  /* Boss Turn: Apply effects */
+  apply_effects(next, &player_armor);
+  if (next->boss_hp <= 0)
+    return ROUND_WON;
+
+  /* Boss attack */
+  dmg = BOSS_DMG - player_armor;
+  if (dmg < 1)
+    dmg = 1;
+  next->player_hp -= dmg;
+  return next->player_hp > 0 ? ROUND_ONGOING : ROUND_LOST;
+}
+
+/* Poison, Recharge, Shield, Missile, Drain */
+const unsigned char spell_order[] = {3, 4, 2, 0, 1};
+
+/* Depth-first branch and bound */
 void solve(GameState *s_ptr) {
   unsigned char i;
-  signed char player_armor;
+  unsigned char result;
   GameState next;
   GameState s;
-  unsigned char h;
   const Spell *sd;
-  unsigned char spell_idx;
-  unsigned char spell_order[] = {
-      3, 4, 2, 0, 1}; /* Poison, Recharge, Shield, Missile, Drain */
 
   s = *s_ptr;
 
@@ -111,39 +272,17 @@ void solve(GameState *s_ptr) {
   }
 
   /* Pruning: Current mana spent + minimum possible mana to finish boss */
-  /* 9 is a very safe lower bound for mana-per-damage. */
-  if (s.mana_spent + (s.boss_hp * 9) >= min_mana)
+  if ((unsigned int)(s.mana_spent + mana_needed(&s)) >= min_mana)
     return;
 
-  /* Memoization check */
-  h = (s.player_hp ^ s.boss_hp ^ s.shield_timer ^ (s.poison_timer << 2) ^
-       (s.recharge_timer << 4)) &
-      (CACHE_SIZE - 1);
-  if (cache_key[h].valid && cache_key[h].hp == s.player_hp &&
-      cache_key[h].boss_hp == s.boss_hp && cache_key[h].s == s.shield_timer &&
-      cache_key[h].p == s.poison_timer && cache_key[h].r == s.recharge_timer) {
-    if (s.mana_spent >= cache_mana[h])
-      return;
-  }
-  cache_key[h].hp = s.player_hp;
-  cache_key[h].boss_hp = s.boss_hp;
-  cache_key[h].s = s.shield_timer;
-  cache_key[h].p = s.poison_timer;
-  cache_key[h].r = s.recharge_timer;
-  cache_key[h].valid = 1;
-  cache_mana[h] = s.mana_spent;
-
-  /* Player turn start */
-  if (hard_mode) {
-    s.player_hp--;
-    if (s.player_hp <= 0)
-      return;
-  }
-
-  /* Apply effects at start of player turn */
-  apply_effects(&s, &player_armor);
+  /* Transposition table check */
+  if (tt_probe(&s))
+    return;
 
-  if (s.boss_hp <= 0) {
+  result = start_turn(&s);
+  if (result == ROUND_LOST)
+    return;
+  if (result == ROUND_WON) {
     if ((unsigned int)s.mana_spent < min_mana)
       min_mana = (unsigned int)s.mana_spent;
     return;
@@ -151,85 +290,161 @@ void solve(GameState *s_ptr) {
 
   /* Try casting each spell */
   for (i = 0; i < 5; ++i) {
-    spell_idx = spell_order[i];
-    sd = &spell_data[spell_idx];
-
-    /* Spell casting checks */
-    if (s.player_mana < sd->cost)
-      continue;
-    if (sd->shield_t && s.shield_timer > 0)
-      continue;
-    if (sd->poison_t && s.poison_timer > 0)
-      continue;
-    if (sd->recharge_t && s.recharge_timer > 0)
+    sd = &spell_data[spell_order[i]];
+    if (!can_cast(&s, sd))
       continue;
 
     next = s;
-    next.player_mana -= sd->cost;
-    next.mana_spent += sd->cost;
-
-    /* Immediate effects */
-    next.boss_hp -= sd->damage;
-    next.player_hp += sd->heal;
-
-    /* Over-time effects */
-    if (sd->shield_t)
-      next.shield_timer = sd->shield_t;
-    if (sd->poison_t)
-      next.poison_timer = sd->poison_t;
-    if (sd->recharge_t)
-      next.recharge_timer = sd->recharge_t;
-
-    if (next.mana_spent + (next.boss_hp * 9) >= min_mana)
+    result = play_round(&next, sd);
+    if ((unsigned int)(next.mana_spent + mana_needed(&next)) >= min_mana)
       continue;
 
-    if (next.boss_hp <= 0) {
+    if (result == ROUND_WON) {
       if ((unsigned int)next.mana_spent < min_mana)
         min_mana = (unsigned int)next.mana_spent;
-      continue;
+    } else if (result == ROUND_ONGOING) {
+      solve(&next);
     }
+  }
+}
 
-    /* Boss Turn: Apply effects */
-    apply_effects(&next, &player_armor);
+void pack_state(const GameState *s, PackedState *p) {
+  p->spent = s->mana_spent;
+  p->mana = s->player_mana;
+  p->hp = s->player_hp;
+  p->boss_hp = s->boss_hp;
+  p->effects = s->shield_timer | (s->poison_timer << 4);
+  p->recharge = s->recharge_timer;
+}
 
-    if (next.boss_hp <= 0) {
-      if ((unsigned int)next.mana_spent < min_mana)
-        min_mana = (unsigned int)next.mana_spent;
+void unpack_state(const PackedState *p, GameState *s) {
+  s->mana_spent = p->spent;
+  s->player_mana = p->mana;
+  s->player_hp = p->hp;
+  s->boss_hp = p->boss_hp;
+  s->shield_timer = p->effects & 0x0F;
+  s->poison_timer = p->effects >> 4;
+  s->recharge_timer = p->recharge;
+}
+
+/* Returns 0 if the heap is full */
+unsigned char heap_push(const GameState *s) {
+  unsigned int i, parent;
+  PackedState item;
+
+  if (heap_len == HEAP_SIZE)
+    return 0;
+  pack_state(s, &item);
+  i = heap_len++;
+  if (heap_len > heap_peak)
+    heap_peak = heap_len;
+  while (i > 0) {
+    parent = (i - 1) >> 1;
+    if (heap[parent].spent <= item.spent)
+      break;
+    heap[i] = heap[parent];
+    i = parent;
+  }
+  heap[i] = item;
+  return 1;
+}
+
+void heap_pop(GameState *s) {
+  unsigned int i = 0, child;
+  PackedState last;
+
+  unpack_state(&heap[0], s);
+  last = heap[--heap_len];
+  for (;;) {
+    child = (i << 1) + 1;
+    if (child >= heap_len)
+      break;
+    if (child + 1 < heap_len && heap[child + 1].spent < heap[child].spent)
+      child++;
+    if (last.spent <= heap[child].spent)
+      break;
+    heap[i] = heap[child];
+    i = child;
+  }
+  heap[i] = last;
+}
+
+/* Uniform-cost search: states leave the heap in order of mana spent, so
+ * the first winning state popped is optimal. Wins are pushed back with
+ * boss_hp 0 rather than returned at once, since a cheaper win may still
+ * be queued. Returns 0 if the heap overflowed. */
+unsigned char solve_ucs(const GameState *start) {
+  unsigned char i;
+  unsigned char result;
+  GameState s;
+  GameState next;
+  const Spell *sd;
+
+  heap_len = 0;
+  heap_peak = 0;
+  heap_push(start);
+
+  while (heap_len) {
+    heap_pop(&s);
+
+    if (s.boss_hp <= 0) {
+      min_mana = s.mana_spent;
+      return 1;
+    }
+
+    /* A state popped before at no greater cost is already expanded */
+    if (tt_probe(&s))
       continue;
+
+    states_count++;
+    if ((states_count & 0x01FF) == 0) {
+      update_progress();
     }
 
-    /* Boss attack */
-    {
-      signed char dmg = BOSS_DMG - player_armor;
-      if (dmg < 1)
-        dmg = 1;
-      next.player_hp -= dmg;
+    result = start_turn(&s);
+    if (result == ROUND_LOST)
+      continue;
+    if (result == ROUND_WON) {
+      s.boss_hp = 0;
+      if ((unsigned int)s.mana_spent < min_mana)
+        min_mana = s.mana_spent;
+      if (!heap_push(&s))
+        return 0;
+      continue;
     }
 
-    if (next.player_hp > 0) {
-      solve(&next);
+    for (i = 0; i < 5; ++i) {
+      sd = &spell_data[spell_order[i]];
+      if (!can_cast(&s, sd))
+        continue;
+
+      next = s;
+      result = play_round(&next, sd);
+      if (result == ROUND_LOST)
+        continue;
+
+      /* The cheapest win queued so far bounds what is worth queueing */
+      if (result == ROUND_WON) {
+        if ((unsigned int)next.mana_spent >= min_mana)
+          continue;
+        next.boss_hp = 0;
+        min_mana = next.mana_spent;
+      } else if ((unsigned int)(next.mana_spent + mana_needed(&next)) >= min_mana) {
+        continue;
+      }
+      if (!heap_push(&next))
+        return 0;
     }
   }
+  return 0;
 }
 
-void main(void) {
+/* Solve one part with one strategy and print the result on row y */
+void run_part(unsigned char part, unsigned char y, unsigned char hard,
+              unsigned char strategy) {
   GameState start;
+  unsigned char ok = 1;
 
-  bgcolor(COLOR_BLACK);
-  bordercolor(COLOR_BLACK);
-  textcolor(COLOR_WHITE);
-  clrscr();
-
-  gotoxy(0, 0);
-  textcolor(COLOR_YELLOW);
-  cprintf("aoc 2015 - day 22: wizard simulator\r\n");
-  textcolor(COLOR_WHITE);
-  cprintf("------------------------------------\r\n");
-  cprintf("boss hp: %d, damage: %d\r\n", BOSS_HP, BOSS_DMG);
-  cprintf("player hp: %d, mana: %d\r\n", PLAYER_START_HP, PLAYER_START_MANA);
-  cprintf("------------------------------------\r\n\r\n");
-
-  /* Initialize common start state */
   start.player_hp = PLAYER_START_HP;
   start.player_mana = PLAYER_START_MANA;
   start.boss_hp = BOSS_HP;
@@ -238,55 +453,67 @@ void main(void) {
   start.recharge_timer = 0;
   start.mana_spent = 0;
 
-  /* Part 1 */
-  gotoxy(0, 6);
-  cprintf("part 1: computing...");
+  gotoxy(0, y);
+  cprintf("part %d %s: computing...", part,
+          strategy == STRATEGY_DFS ? "dfs" : "ucs");
   min_mana = 0xFFFF;
-  hard_mode = 0;
+  hard_mode = hard;
   states_count = 0;
-  memset(cache_key, 0, sizeof(cache_key));
-  solve(&start);
+  tt_clear();
+  if (strategy == STRATEGY_DFS) {
+    solve(&start);
+  } else {
+    ok = solve_ucs(&start);
+  }
 
-  gotoxy(0, 6);
+  gotoxy(0, y);
   cclear(40);
-  gotoxy(0, 6);
+  gotoxy(0, y);
   textcolor(COLOR_WHITE);
-  cprintf("part 1: ");
-  textcolor(COLOR_GREEN);
-  cprintf("%u", min_mana);
+  cprintf("part %d %s: ", part, strategy == STRATEGY_DFS ? "dfs" : "ucs");
+  textcolor(ok ? COLOR_GREEN : COLOR_RED);
+  if (ok) {
+    cprintf("%u", min_mana);
+  } else {
+    cprintf("heap full");
+  }
   textcolor(COLOR_WHITE);
+  cprintf(" (%lu states)", states_count);
+  gotoxy(0, y + 1);
+  cprintf("  tt %lu hit/%lu miss", tt_hits, tt_misses);
+  if (strategy == STRATEGY_UCS) {
+    cprintf(", heap %u", heap_peak);
+  }
+}
 
-  /* Part 2: Re-initialize for Hard Mode */
-  gotoxy(0, 8);
-  cprintf("part 2: computing...");
-  start.player_hp = PLAYER_START_HP;
-  start.player_mana = PLAYER_START_MANA;
-  start.boss_hp = BOSS_HP;
-  start.shield_timer = 0;
-  start.poison_timer = 0;
-  start.recharge_timer = 0;
-  start.mana_spent = 0;
-
-  min_mana = 0xFFFF;
-  hard_mode = 1;
-  states_count = 0;
-  memset(cache_key, 0, sizeof(cache_key));
-  solve(&start);
+void main(void) {
 
-  gotoxy(0, 8);
-  cclear(40);
-  gotoxy(0, 8);
+  bgcolor(COLOR_BLACK);
+  bordercolor(COLOR_BLACK);
   textcolor(COLOR_WHITE);
-  cprintf("part 2: ");
-  textcolor(COLOR_GREEN);
-  cprintf("%u", min_mana);
+  clrscr();
+
+  gotoxy(0, 0);
+  textcolor(COLOR_YELLOW);
+  cprintf("aoc 2015 - day 22: wizard simulator\r\n");
   textcolor(COLOR_WHITE);
+  cprintf("------------------------------------\r\n");
+  cprintf("boss hp: %d, damage: %d\r\n", BOSS_HP, BOSS_DMG);
+  cprintf("player hp: %d, mana: %d\r\n", PLAYER_START_HP, PLAYER_START_MANA);
+  cprintf("------------------------------------\r\n\r\n");
 
-  gotoxy(0, 12);
+#if STRATEGY & STRATEGY_DFS
+  run_part(1, 6, 0, STRATEGY_DFS);
+  run_part(2, 11, 1, STRATEGY_DFS);
+#endif
+#if STRATEGY & STRATEGY_UCS
+  run_part(1, 8, 0, STRATEGY_UCS);
+  run_part(2, 13, 1, STRATEGY_UCS);
+#endif
+
+  gotoxy(0, PROGRESS_ROW);
   cclear(40);
-  gotoxy(0, 14);
+  gotoxy(0, PROGRESS_ROW + 2);
   cprintf("press any key to exit...");
   cgetc();
 }
-
-
@@ -10,149 +10,248 @@
 #include <string.h>
 #include <conio.h>
 #include <time.h>
+#include "int64.h"
 
 #define MAX_WEIGHTS 32
 
-/* 64-bit unsigned integer structure and math for Quantum Entanglement */
+unsigned int weights[MAX_WEIGHTS];
+unsigned char n_weights;
+u64 best_qe;
+unsigned int target_weight;
+
+/*
+ * Best-first enumeration of first-group candidates.
+ *
+ * Weights are sorted ascending.  A node is a combination i1 < ... < ik and
+ * has at most two successors: "append" adds item ik+1, "replace" swaps ik
+ * for ik+1.  Starting from {0}, every combination is generated exactly once.
+ * The key of a node is its QE times the product of the smallest packages
+ * that could complete it; neither successor can have a smaller key, so full
+ * groups leave the frontier in increasing QE order and the first one whose
+ * remainder balances is the answer.
+ */
+#define FRONTIER_SIZE 256
+#define MAX_TARGET 2047
+
+/* search_size results */
+#define SEARCH_NONE 0       /* no group of this size balances */
+#define SEARCH_FOUND 1      /* best_qe is the minimum */
+#define SEARCH_OVERFLOW 2   /* nodes were dropped; no verified answer */
+
 typedef struct {
-    unsigned long low;
-    unsigned long high;
-} uint64_t_c64;
+    u64 bound;              /* lower bound on the QE of any completion */
+    u64 prefix;             /* product of the chosen weights except the last */
+    unsigned long mask;     /* bit i set = weights[i] is in the group */
+    unsigned int sum;
+    unsigned char last;
+    unsigned char count;
+} Node;
 
-void set64(uint64_t_c64* a, unsigned long low, unsigned long high) {
-    a->low = low;
-    a->high = high;
-}
+Node frontier[FRONTIER_SIZE];
+unsigned int frontier_len;
+unsigned int frontier_peak;
+unsigned char frontier_overflow;
+u64 dropped_bound;          /* smallest bound of a node dropped when full */
+unsigned long nodes_popped;
+unsigned int candidates_checked;
 
-void copy64(uint64_t_c64* dest, uint64_t_c64* src) {
-    dest->low = src->low;
-    dest->high = src->high;
-}
+unsigned long bit32[MAX_WEIGHTS];
+unsigned int prefix_sum[MAX_WEIGHTS + 1];  /* sum of weights[0..i-1] */
+unsigned char group_size;
+
+/* reach bit s = some subset of the remaining packages weighs s */
+unsigned char reach[MAX_TARGET / 8 + 1];
+
+static void frontier_push(Node* node) {
+    unsigned int i = frontier_len;
+    unsigned int parent;
+
+    if (frontier_len == FRONTIER_SIZE) {
+        /* Nothing below the lightest dropped bound is lost */
+        if (!frontier_overflow || u64_cmp(&node->bound, &dropped_bound) < 0) {
+            dropped_bound = node->bound;
+        }
+        frontier_overflow = 1;
+        return;
+    }
+    ++frontier_len;
+    if (frontier_len > frontier_peak) frontier_peak = frontier_len;
 
-/* 64-bit multiplication: a = a * b */
-void mul64(uint64_t_c64* a, unsigned int b) {
-    unsigned long r0, r1, r2, r3;
-    unsigned long a0 = a->low & 0xFFFF;
-    unsigned long a1 = (a->low >> 16) & 0xFFFF;
-    unsigned long a2 = a->high & 0xFFFF;
-    unsigned long a3 = (a->high >> 16) & 0xFFFF;
-
-    r0 = a0 * b;
-    r1 = a1 * b + (r0 >> 16);
-    r2 = a2 * b + (r1 >> 16);
-    r3 = a3 * b + (r2 >> 16);
-
-    a->low = (r0 & 0xFFFF) | ((r1 & 0xFFFF) << 16);
-    a->high = (r2 & 0xFFFF) | ((r3 & 0xFFFF) << 16);
+    while (i > 0) {
+        parent = (i - 1) >> 1;
+        if (u64_cmp(&frontier[parent].bound, &node->bound) <= 0) break;
+        frontier[i] = frontier[parent];
+        i = parent;
+    }
+    frontier[i] = *node;
 }
 
-/* Compare two 64-bit integers: -1 if a < b, 1 if a > b, 0 if equal */
-int compare64(uint64_t_c64* a, uint64_t_c64* b) {
-    if (a->high < b->high) return -1;
-    if (a->high > b->high) return 1;
-    if (a->low < b->low) return -1;
-    if (a->low > b->low) return 1;
-    return 0;
+static void frontier_pop(Node* out) {
+    unsigned int i = 0;
+    unsigned int child;
+    Node* tail;
+
+    *out = frontier[0];
+    tail = &frontier[--frontier_len];
+    for (;;) {
+        child = (i << 1) + 1;
+        if (child >= frontier_len) break;
+        if (child + 1 < frontier_len &&
+            u64_cmp(&frontier[child + 1].bound, &frontier[child].bound) < 0) {
+            ++child;
+        }
+        if (u64_cmp(&tail->bound, &frontier[child].bound) <= 0) break;
+        frontier[i] = frontier[child];
+        i = child;
+    }
+    frontier[i] = *tail;
 }
 
-/* Convert uint64 to decimal string */
-void format64(uint64_t_c64* a, char* buf) {
-    char temp[21];
-    int i = 0;
-    uint64_t_c64 val;
-    val.low = a->low;
-    val.high = a->high;
+/* Queue a node unless even its lightest completion overshoots the target. */
+static void push_node(u64* prefix, unsigned long mask, unsigned int sum,
+                      unsigned char last, unsigned char count) {
+    unsigned char missing = group_size - count;
+    unsigned char i;
+    Node node;
 
-    if (val.low == 0 && val.high == 0) {
-        strcpy(buf, "0");
-        return;
+    if (last + missing >= n_weights) return;
+    if (sum + prefix_sum[last + 1 + missing] - prefix_sum[last + 1] > target_weight) return;
+
+    node.prefix = *prefix;
+    node.bound = *prefix;
+    u64_mul16(&node.bound, weights[last]);
+    for (i = 1; i <= missing; ++i) {
+        u64_mul16(&node.bound, weights[last + i]);
     }
-    while (val.low != 0 || val.high != 0) {
-        unsigned long rem = 0;
-        unsigned long n3 = (val.high >> 16) & 0xFFFF;
-        unsigned long n2 = val.high & 0xFFFF;
-        unsigned long n1 = (val.low >> 16) & 0xFFFF;
-        unsigned long n0 = val.low & 0xFFFF;
-        
-        unsigned long q3, q2, q1, q0;
-        
-        q3 = n3 / 10;
-        rem = n3 % 10;
-        q2 = (rem * 65536L + n2) / 10;
-        rem = (rem * 65536L + n2) % 10;
-        q1 = (rem * 65536L + n1) / 10;
-        rem = (rem * 65536L + n1) % 10;
-        q0 = (rem * 65536L + n0) / 10;
-        rem = (rem * 65536L + n0) % 10;
-        
-        temp[i++] = (char)('0' + rem);
-        val.high = (q3 << 16) | (q2 & 0xFFFF);
-        val.low = (q1 << 16) | (q0 & 0xFFFF);
+    node.mask = mask;
+    node.sum = sum;
+    node.last = last;
+    node.count = count;
+    frontier_push(&node);
+}
+
+/* Bitset subset sum: can the packages in 'rest' make exactly the target? */
+static unsigned char reaches_target(unsigned long rest) {
+    unsigned char top = (unsigned char)(target_weight >> 3);
+    unsigned char i;
+    int j;
+
+    memset(reach, 0, top + 1);
+    reach[0] = 1;
+    for (i = 0; i < n_weights; ++i) {
+        unsigned char q, b;
+        if (!(rest & bit32[i])) continue;
+        q = (unsigned char)(weights[i] >> 3);
+        b = (unsigned char)(weights[i] & 7);
+        /* reach |= reach << w, high bytes first so each package counts once */
+        for (j = top; j >= q; --j) {
+            unsigned char v = (unsigned char)(reach[j - q] << b);
+            if (b && j > q) v |= (unsigned char)(reach[j - q - 1] >> (8 - b));
+            reach[j] |= v;
+        }
     }
-    temp[i] = '\0';
-    {
-        int j;
-        for (j = 0; j < i; ++j) {
-            buf[j] = temp[i - 1 - j];
+    return (reach[top] >> (target_weight & 7)) & 1;
+}
+
+static unsigned char can_split(unsigned long rest, unsigned char groups);
+
+/* Grow 'group' from weights[i] downwards until it needs nothing more. */
+static unsigned char split_dfs(unsigned long rest, unsigned long group, signed char i,
+                               unsigned int need, unsigned char groups) {
+    for (; i >= 0; --i) {
+        unsigned int w;
+        if (!(rest & bit32[i])) continue;
+        w = weights[i];
+        if (w > need) continue;
+        if (w == need) {
+            if (can_split(rest & ~(group | bit32[i]), groups - 1)) return 1;
+        } else if (split_dfs(rest, group | bit32[i], i - 1, need - w, groups)) {
+            return 1;
         }
-        buf[i] = '\0';
     }
+    return 0;
 }
 
-unsigned int weights[MAX_WEIGHTS];
-unsigned char n_weights;
-uint64_t_c64 best_qe;
-unsigned char found_any;
-unsigned long target_weight;
-
-/* 
- * Recursive combination search with pruning.
- * Precondition: The global 'weights' array MUST be sorted in descending order
- * for the 'Strong prune' condition to be valid.
+/*
+ * Can 'rest' (which weighs groups * target) be cut into 'groups' equal
+ * groups?  Two groups is a single subset-sum test; with more, the heaviest
+ * package seeds one group and the rest are checked recursively.
  */
-void find_combinations(unsigned char start_idx, unsigned char count, unsigned long current_target, uint64_t_c64* current_qe) {
+static unsigned char can_split(unsigned long rest, unsigned char groups) {
+    signed char h;
+
+    if (groups <= 1) return 1;
+    if (groups == 2) return reaches_target(rest);
+
+    for (h = n_weights - 1; !(rest & bit32[h]); --h) ;
+    if (weights[h] == target_weight) {
+        return can_split(rest & ~bit32[h], groups - 1);
+    }
+    return split_dfs(rest, bit32[h], h - 1, target_weight - weights[h], groups);
+}
+
+/*
+ * Pop candidates of the current group size in QE order.  If the frontier
+ * overflowed, the order still holds up to the lightest dropped bound; past
+ * it (or when the frontier runs dry) the search can no longer be trusted.
+ */
+static unsigned char search_size(unsigned char num_groups) {
+    unsigned long all = 0;
     unsigned char i;
-    if (count == 0) {
-        if (current_target == 0) {
-            if (!found_any || compare64(current_qe, &best_qe) < 0) {
-                copy64(&best_qe, current_qe);
-                found_any = 1;
+    u64 one, qe;
+    Node node;
+
+    for (i = 0; i < n_weights; ++i) all |= bit32[i];
+
+    frontier_len = 0;
+    frontier_overflow = 0;
+    u64_set(&one, 1);
+    push_node(&one, bit32[0], weights[0], 0, 1);
+
+    while (frontier_len > 0) {
+        frontier_pop(&node);
+        ++nodes_popped;
+        if (frontier_overflow && u64_cmp(&node.bound, &dropped_bound) > 0) {
+            return SEARCH_OVERFLOW;
+        }
+
+        if (node.count == group_size) {
+            if (node.sum == target_weight) {
+                ++candidates_checked;
+                if (can_split(all & ~node.mask, num_groups - 1)) {
+                    best_qe = node.bound;
+                    return SEARCH_FOUND;
+                }
             }
+        } else if (node.sum + prefix_sum[n_weights] -
+                   prefix_sum[n_weights - (group_size - node.count)] >= target_weight) {
+            /* The heaviest completion still reaches the target: extend. */
+            qe = node.prefix;
+            u64_mul16(&qe, weights[node.last]);
+            push_node(&qe, node.mask | bit32[node.last + 1],
+                      node.sum + weights[node.last + 1], node.last + 1, node.count + 1);
         }
-        return;
-    }
 
-    for (i = start_idx; i <= n_weights - count; ++i) {
-        unsigned int w = weights[i];
-        if (w > current_target) continue;
-        
-        /* Strong prune: if even 'count' largest remaining (weights[i]) can't reach target */
-        if ((unsigned long)w * count < current_target) break;
-
-        {
-            uint64_t_c64 next_qe;
-            copy64(&next_qe, current_qe);
-            mul64(&next_qe, w);
-            
-            /* Prune: if current product is already worse than best found */
-            if (found_any && compare64(&next_qe, &best_qe) >= 0) continue;
-
-            find_combinations(i + 1, count - 1, current_target - w, &next_qe);
+        if (node.last + 1 < n_weights) {
+            push_node(&node.prefix,
+                      (node.mask & ~bit32[node.last]) | bit32[node.last + 1],
+                      node.sum - weights[node.last] + weights[node.last + 1],
+                      node.last + 1, node.count);
         }
     }
+    return frontier_overflow ? SEARCH_OVERFLOW : SEARCH_NONE;
 }
 
 void solve(unsigned char num_groups) {
     unsigned long total_weight = 0;
-    unsigned char r, i, j;
-    char buf[32];
+    unsigned char r, i, j, result;
+    char buf[U64_FORMAT_SIZE];
     clock_t start_time, end_time;
 
-    /* Sort weights in descending order for optimal pruning.
-       Uses a simple selection sort, efficient enough for MAX_WEIGHTS=32. */
+    /* Sort weights ascending: a later package never lowers the QE. */
     for (i = 0; i < n_weights - 1; ++i) {
         for (j = i + 1; j < n_weights; ++j) {
-            if (weights[i] < weights[j]) {
+            if (weights[i] > weights[j]) {
                 unsigned int tmp = weights[i];
                 weights[i] = weights[j];
                 weights[j] = tmp;
@@ -160,24 +259,44 @@ void solve(unsigned char num_groups) {
         }
     }
 
-    for (i = 0; i < n_weights; ++i) total_weight += weights[i];
-    target_weight = total_weight / num_groups;
+    prefix_sum[0] = 0;
+    for (i = 0; i < n_weights; ++i) {
+        bit32[i] = (i == 0) ? 1UL : bit32[i - 1] << 1;
+        total_weight += weights[i];
+        prefix_sum[i + 1] = (unsigned int)total_weight;
+    }
+
+    printf("Groups: %d, Total: %lu\n", num_groups, total_weight);
+    if (total_weight % num_groups != 0) {
+        printf("Total does not split evenly.\n");
+        return;
+    }
+    if (total_weight / num_groups > MAX_TARGET) {
+        printf("Error: target above %d!\n", MAX_TARGET);
+        return;
+    }
+    target_weight = (unsigned int)(total_weight / num_groups);
+    printf("Target: %u\n", target_weight);
 
-    printf("Groups: %d, Target: %lu\n", num_groups, target_weight);
-    
     start_time = clock();
-    found_any = 0;
+    frontier_peak = 0;
+    nodes_popped = 0;
+    candidates_checked = 0;
     /* Try increasing group sizes to find the absolute minimum number of packages */
     for (r = 1; r <= n_weights; ++r) {
-        uint64_t_c64 start_qe;
         printf("Size %d... ", r);
-        set64(&start_qe, 1, 0);
-        find_combinations(0, r, target_weight, &start_qe);
-        
-        if (found_any) {
+        group_size = r;
+        result = search_size(num_groups);
+        if (result == SEARCH_OVERFLOW) {
+            printf("\nFrontier overflowed: no verified QE.\n");
+            return;
+        }
+        if (result == SEARCH_FOUND) {
             end_time = clock();
-            format64(&best_qe, buf);
+            u64_format(&best_qe, buf);
             printf("\nQE: %s\n", buf);
+            printf("Nodes %lu, cands %u, peak %u\n",
+                   nodes_popped, candidates_checked, frontier_peak);
             printf("Time: %lu ticks\n", (unsigned long)(end_time - start_time));
             return;
         }
@@ -189,9 +308,9 @@ int main() {
     /* Example weights from the problem description */
     unsigned int example_weights[] = {11, 10, 9, 8, 7, 5, 4, 3, 2, 1};
     
-    /* Typical real input data (first 30 primes/values approx) */
+    /* Typical real input: 1, 2, 3 and primes up to 113, weighing 1560 */
     unsigned int real_weights[] = {
-        113, 109, 107, 103, 101, 97, 89, 83, 79, 73, 71, 67, 61, 59, 53, 47, 43, 41, 37, 31, 29, 23, 19, 17, 13, 11, 7, 5, 3, 1
+        1, 2, 3, 7, 11, 13, 17, 19, 23, 31, 37, 41, 43, 47, 53, 59, 61, 67, 71, 73, 79, 83, 89, 97, 101, 103, 107, 109, 113
     };
 
     clrscr();
@@ -213,7 +332,7 @@ int main() {
     cgetc();
 
     /* Then run real data simulation */
-    printf("\nReal Data Simulation (30 pkgs):\n");
+    printf("\nReal Data Simulation (29 pkgs):\n");
     n_weights = sizeof(real_weights) / sizeof(real_weights[0]);
     if (n_weights > MAX_WEIGHTS) {
         printf("Error: too many real weights!\n");
@@ -1,10 +1,39 @@
 #include <conio.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 
-// Grid size for tracking visited houses (11x11 centered on origin)
-#define GRID_SIZE 11
-#define OFFSET 5  // (0,0) maps to [5][5]
+// Visited houses live in an open-addressing hash set of packed
+// coordinates: high byte x + 128, low byte y + 128. Key 0 would be
+// (-128,-128), which is outside the packable range, so it marks a free slot.
+#define EMPTY_KEY 0
+#define COORD_LIMIT 127
+
+// The table starts small and doubles whenever it is 3/4 full. 8192 slots
+// (16KB) hold 6144 houses; a real 8192-move input visits up to about 2600.
+// While growing, the old and new tables are both allocated (24KB at most).
+#define MIN_SLOTS 256
+#define MAX_SLOTS 8192
+
+unsigned int* slots = NULL;
+unsigned int slot_count;
+unsigned int slot_mask;
+unsigned char slot_shift;   // 16 - log2(slot_count)
+unsigned int house_count;
+unsigned char set_full;      // 1 once a house found no room in the table
+unsigned char out_of_range;  // 1 once a walker went past +-127
+
+// Input is read from disk in blocks of this size
+#define BLOCK_SIZE 256
+char read_block[BLOCK_SIZE];
+
+// Santa (walker 0) and Robo-Santa (walker 1) take turns when walkers is 2
+typedef struct {
+    int x[2];
+    int y[2];
+    unsigned char turn;
+    unsigned char walkers;
+} Tracker;
 
 // Test inputs for Part 1
 #define PART1_TEST_COUNT 3
@@ -14,7 +43,7 @@ const char* part1_tests[PART1_TEST_COUNT] = {
     "^v^v^v^v^v"   // 2 houses: alternating up/down
 };
 
-const int part1_expected[PART1_TEST_COUNT] = {2, 4, 2};
+const unsigned int part1_expected[PART1_TEST_COUNT] = {2, 4, 2};
 
 // Test inputs for Part 2
 #define PART2_TEST_COUNT 3
@@ -24,120 +53,189 @@ const char* part2_tests[PART2_TEST_COUNT] = {
     "^v^v^v^v^v"   // 11 houses: Santa up, Robot Santa down
 };
 
-const int part2_expected[PART2_TEST_COUNT] = {3, 3, 11};
+const unsigned int part2_expected[PART2_TEST_COUNT] = {3, 3, 11};
 
-void clear_visited_grid(char visited[GRID_SIZE][GRID_SIZE]) {
-    memset(visited, 0, sizeof(char) * GRID_SIZE * GRID_SIZE);
+unsigned int pack_house(int x, int y) {
+    return ((unsigned int)(x + 128) << 8) | (unsigned char)(y + 128);
 }
 
-int visit_if_new(char visited[GRID_SIZE][GRID_SIZE], int x, int y) {
-    if (x + OFFSET >= 0 && x + OFFSET < GRID_SIZE &&
-        y + OFFSET >= 0 && y + OFFSET < GRID_SIZE) {
-        if (visited[y + OFFSET][x + OFFSET] == 0) {
-            visited[y + OFFSET][x + OFFSET] = 1;
-            return 1;
-        }
-    }
-    return 0;
+// Fibonacci hashing: the top bits of key * 2^16 / phi pick the slot
+unsigned int hash_key(unsigned int key) {
+    return ((key * 40503u) & 0xFFFFu) >> slot_shift;
 }
 
-int track_santa_visits(const char* directions) {
-    char visited[GRID_SIZE][GRID_SIZE];
-    int x, y;
-    int unique_houses;
-    const char* p;
+// Allocate an empty table of 'count' slots (a power of two)
+unsigned char alloc_slots(unsigned int count) {
+    unsigned char bits;
 
-    clear_visited_grid(visited);
+    slots = (unsigned int*)malloc(count * sizeof(unsigned int));
+    if (slots == NULL) {
+        return 0;
+    }
+    memset(slots, 0, count * sizeof(unsigned int));
+    slot_count = count;
+    slot_mask = count - 1;
+    for (bits = 0; (1u << bits) < count; bits++) {
+    }
+    slot_shift = 16 - bits;
+    return 1;
+}
 
-    x = 0;
-    y = 0;
-    unique_houses = 1;  // Start with the initial house
+unsigned char clear_houses(void) {
+    free(slots);
+    house_count = 0;
+    set_full = 0;
+    out_of_range = 0;
+    return alloc_slots(MIN_SLOTS);
+}
 
-    // Mark starting position as visited
-    visited[y + OFFSET][x + OFFSET] = 1;
+// Double the table and re-insert every key; the old table is kept if
+// there is no room for the new one
+unsigned char grow_houses(void) {
+    unsigned int* old = slots;
+    unsigned int old_count = slot_count;
+    unsigned char old_shift = slot_shift;
+    unsigned int i, h;
 
-    // Process each direction
-    p = directions;
-    while (*p) {
-        switch (*p) {
-            case '^': y++; break;  // north
-            case 'v': y--; break;  // south
-            case '>': x++; break;  // east
-            case '<': x--; break;  // west
+    if (old_count >= MAX_SLOTS) {
+        return 0;
+    }
+    if (!alloc_slots(old_count * 2)) {
+        slots = old;
+        slot_mask = old_count - 1;
+        slot_shift = old_shift;
+        return 0;
+    }
+    for (i = 0; i < old_count; i++) {
+        if (old[i] != EMPTY_KEY) {
+            h = hash_key(old[i]);
+            while (slots[h] != EMPTY_KEY) {
+                h = (h + 1) & slot_mask;
+            }
+            slots[h] = old[i];
         }
+    }
+    free(old);
+    return 1;
+}
+
+// Mark a house visited; 1 if it had not been visited before
+unsigned char visit_house(int x, int y) {
+    unsigned int key, h;
 
-        // Check bounds (shouldn't exceed grid in test cases)
-        if (visit_if_new(visited, x, y)) {
-            unique_houses++;
+    if (x < -COORD_LIMIT || x > COORD_LIMIT ||
+        y < -COORD_LIMIT || y > COORD_LIMIT) {
+        out_of_range = 1;
+        return 0;
+    }
+    key = pack_house(x, y);
+    h = hash_key(key);
+    while (slots[h] != EMPTY_KEY) {
+        if (slots[h] == key) {
+            return 0;
         }
+        h = (h + 1) & slot_mask;
+    }
 
-        p++;
+    if (house_count >= slot_count - (slot_count >> 2)) {
+        if (!grow_houses()) {
+            set_full = 1;
+            return 0;
+        }
+        h = hash_key(key);
+        while (slots[h] != EMPTY_KEY) {
+            h = (h + 1) & slot_mask;
+        }
     }
+    slots[h] = key;
+    house_count++;
+    return 1;
+}
 
-    return unique_houses;
+// Start a run with 1 (Santa) or 2 (Santa and Robo-Santa) walkers at (0,0)
+void tracker_reset(Tracker* t, unsigned char walkers) {
+    memset(t, 0, sizeof(Tracker));
+    t->walkers = walkers;
+    if (!clear_houses()) {
+        set_full = 1;
+        return;
+    }
+    visit_house(0, 0);
 }
 
-int track_santa_and_robot_santa(const char* directions) {
-    char visited[GRID_SIZE][GRID_SIZE];
-    int santa_x, santa_y;
-    int robot_x, robot_y;
-    int unique_houses;
-    const char* p;
-    int turn;
+// Feed one input character; anything but a direction is skipped
+void tracker_put(Tracker* t, char c) {
+    unsigned char w = t->turn;
 
-    clear_visited_grid(visited);
+    switch (c) {
+        case '^': t->y[w]++; break;  // north
+        case 'v': t->y[w]--; break;  // south
+        case '>': t->x[w]++; break;  // east
+        case '<': t->x[w]--; break;  // west
+        default: return;
+    }
+    if (slots != NULL) {
+        visit_house(t->x[w], t->y[w]);
+    }
+    if (t->walkers == 2) {
+        t->turn = 1 - w;
+    }
+}
 
-    santa_x = 0;
-    santa_y = 0;
-    robot_x = 0;
-    robot_y = 0;
-    unique_houses = 1;  // Start with the initial house
+unsigned int track_string(const char* directions, unsigned char walkers) {
+    Tracker t;
 
-    // Mark starting position as visited
-    visited[0 + OFFSET][0 + OFFSET] = 1;
+    tracker_reset(&t, walkers);
+    while (*directions) {
+        tracker_put(&t, *directions++);
+    }
+    return house_count;
+}
 
-    // Process each direction, alternating between Santa and Robot Santa
-    p = directions;
-    turn = 0;  // 0 = Santa, 1 = Robot Santa
+unsigned int track_santa_visits(const char* directions) {
+    return track_string(directions, 1);
+}
 
-    while (*p) {
-        int* curr_x = (turn == 0) ? &santa_x : &robot_x;
-        int* curr_y = (turn == 0) ? &santa_y : &robot_y;
+unsigned int track_santa_and_robot_santa(const char* directions) {
+    return track_string(directions, 2);
+}
 
-        switch (*p) {
-            case '^': (*curr_y)++; break;  // north
-            case 'v': (*curr_y)--; break;  // south
-            case '>': (*curr_x)++; break;  // east
-            case '<': (*curr_x)--; break;  // west
-        }
+// Stream a file through the tracker; the directions never sit in memory
+// as a whole, only one block of them at a time
+unsigned char track_file(const char* filename, unsigned char walkers) {
+    FILE* fp;
+    Tracker t;
+    size_t len, i;
 
-        // Check bounds and mark as visited if new
-        if (visit_if_new(visited, *curr_x, *curr_y)) {
-            unique_houses++;
+    fp = fopen(filename, "r");
+    if (!fp) {
+        return 0;
+    }
+    tracker_reset(&t, walkers);
+    while ((len = fread(read_block, 1, BLOCK_SIZE, fp)) > 0) {
+        for (i = 0; i < len; i++) {
+            tracker_put(&t, read_block[i]);
         }
-
-        turn = 1 - turn;  // Switch turns
-        p++;
     }
-
-    return unique_houses;
+    fclose(fp);
+    return 1;
 }
 
 void test_part1(void) {
     size_t i;
-    int result;
+    unsigned int result;
 
     cprintf("Part 1 Tests:\r\n");
     cprintf("============\r\n");
 
     for (i = 0; i < sizeof(part1_tests) / sizeof(part1_tests[0]); i++) {
         result = track_santa_visits(part1_tests[i]);
-        cprintf("Input: %s -> Houses: %d", part1_tests[i], result);
+        cprintf("Input: %s -> Houses: %u", part1_tests[i], result);
 
         if (result == part1_expected[i]) {
             cprintf(" (PASS)\r\n");
         } else {
-            cprintf(" (FAIL - expected %d)\r\n", part1_expected[i]);
+            cprintf(" (FAIL - expected %u)\r\n", part1_expected[i]);
         }
     }
     cprintf("\r\n");
@@ -145,19 +243,71 @@ void test_part1(void) {
 
 void test_part2(void) {
     size_t i;
-    int result;
+    unsigned int result;
 
     cprintf("Part 2 Tests:\r\n");
     cprintf("============\r\n");
 
     for (i = 0; i < sizeof(part2_tests) / sizeof(part2_tests[0]); i++) {
         result = track_santa_and_robot_santa(part2_tests[i]);
-        cprintf("Input: %s -> Houses: %d", part2_tests[i], result);
+        cprintf("Input: %s -> Houses: %u", part2_tests[i], result);
 
         if (result == part2_expected[i]) {
             cprintf(" (PASS)\r\n");
         } else {
-            cprintf(" (FAIL - expected %d)\r\n", part2_expected[i]);
+            cprintf(" (FAIL - expected %u)\r\n", part2_expected[i]);
+        }
+    }
+    cprintf("\r\n");
+}
+
+// A 40-row zigzag, 1600 moves: far past the old 11x11 grid, and enough
+// houses to grow the table from 256 to 4096 slots
+void test_large(void) {
+    Tracker t;
+    unsigned char walkers, row, step;
+    const unsigned int expected[2] = {1601, 802};
+
+    cprintf("Large Test (40x40 zigzag):\r\n");
+    cprintf("==========================\r\n");
+
+    for (walkers = 1; walkers <= 2; walkers++) {
+        tracker_reset(&t, walkers);
+        for (row = 0; row < 40; row++) {
+            for (step = 0; step < 39; step++) {
+                tracker_put(&t, (row & 1) ? '<' : '>');
+            }
+            tracker_put(&t, '^');
+        }
+        cprintf("Part %u -> Houses: %u (%u slots)", walkers, house_count,
+                slot_count);
+        if (!set_full && !out_of_range && house_count == expected[walkers - 1]) {
+            cprintf(" (PASS)\r\n");
+        } else {
+            cprintf(" (FAIL - expected %u)\r\n", expected[walkers - 1]);
+        }
+    }
+    cprintf("\r\n");
+}
+
+// Solve input.txt in both modes, reading it from disk once per mode
+void solve_input(void) {
+    unsigned char walkers;
+
+    for (walkers = 1; walkers <= 2; walkers++) {
+        if (!track_file("input.txt", walkers)) {
+            cprintf("input.txt not found.\r\n\r\n");
+            return;
+        }
+        if (out_of_range) {
+            cprintf("Part %u: at least %u houses (out of range)\r\n",
+                    walkers, house_count);
+        } else if (set_full) {
+            cprintf("Part %u: at least %u houses (set full)\r\n", walkers,
+                    house_count);
+        } else {
+            cprintf("Part %u: %u houses (%u slots)\r\n", walkers,
+                    house_count, slot_count);
         }
     }
     cprintf("\r\n");
@@ -171,6 +321,8 @@ int main(void) {
 
     test_part1();
     test_part2();
+    test_large();
+    solve_input();
 
     cprintf("Press any key to exit...\r\n");
     cgetc();
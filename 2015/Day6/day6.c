@@ -2,39 +2,59 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-
-// Constants for demonstration grid (50x50 fits in C64 memory ~2.5KB)
-#define DEMO_ROWS 50
-#define DEMO_COLS 50
-
-// Global grids to avoid cc65 local variable limits
-char part1_grid[DEMO_ROWS][DEMO_COLS];
-unsigned int part2_grid[DEMO_ROWS][DEMO_COLS];
-
-// Test instructions for Part 1 (scaled for 50x50 demo grid)
+#ifdef __CC65__
+#include <c64.h>
+#include <em.h>
+#endif
+
+// Full puzzle grid for Part 1: one bit per light, 125 bytes per row
+#define GRID_SIZE 1000
+#define ROW_BYTES (GRID_SIZE / 8)
+#define BITMAP_PAGES ((GRID_SIZE * (unsigned long)ROW_BYTES + 255) / 256)
+
+#ifdef __CC65__
+// 125,000 bytes do not fit in C64 RAM: rows live in the REU and one span
+// at a time is copied into span_buf, modified and written back
+unsigned char span_buf[ROW_BYTES];
+struct em_copy span_copy;
+#else
+unsigned char bitmap[GRID_SIZE][ROW_BYTES];
+#endif
+
+// Bit (7 - x % 8) of byte x / 8 is light x; masks for partial edge bytes
+const unsigned char left_mask[8] = {0xFF, 0x7F, 0x3F, 0x1F, 0x0F, 0x07, 0x03, 0x01};
+const unsigned char right_mask[8] = {0x80, 0xC0, 0xE0, 0xF0, 0xF8, 0xFC, 0xFE, 0xFF};
+
+// Number of set bits in each byte value, filled by bitmap_init
+unsigned char bit_count[256];
+
+// 1 when bitmap_init found room for the bitmap
+unsigned char bitmap_ready;
+
+// Test instructions for Part 1 (the puzzle's own 1000x1000 examples)
 #define PART1_TEST_COUNT 3
 const char* part1_instructions[PART1_TEST_COUNT] = {
-    "turn on 0,0 through 49,49",     // Turn on all lights in 50x50 grid
-    "toggle 0,0 through 49,0",       // Toggle first row (50 lights)
-    "turn off 24,24 through 25,25"   // Turn off 2x2 square in middle (4 lights)
+    "turn on 0,0 through 999,999",     // Turn on every light
+    "toggle 0,0 through 999,0",        // Toggle first line (1,000 lights)
+    "turn off 499,499 through 500,500" // Turn off 2x2 square in middle (4 lights)
 };
 
 const unsigned long part1_expected[PART1_TEST_COUNT] = {
-    2500,  // All 50x50 grid on: 50 * 50 = 2,500
-    2450,  // First row toggled off: 2,500 - 50 = 2,450
-    2446   // Middle 4 turned off: 2,450 - 4 = 2,446
+    1000000, // All lights on: 1000 * 1000 = 1,000,000
+    999000,  // First line toggled off: 1,000,000 - 1,000 = 999,000
+    998996   // Middle 4 turned off: 999,000 - 4 = 998,996
 };
 
-// Test instructions for Part 2 (scaled for 50x50 demo grid)
+// Test instructions for Part 2 (the puzzle's own 1000x1000 examples)
 #define PART2_TEST_COUNT 2
 const char* part2_instructions[PART2_TEST_COUNT] = {
     "turn on 0,0 through 0,0",     // Single light +1 brightness
-    "toggle 0,0 through 49,49"     // All lights toggle +2 each
+    "toggle 0,0 through 999,999"   // All lights toggle +2 each
 };
 
 const unsigned long part2_expected[PART2_TEST_COUNT] = {
-    1,      // Single light brightness +1
-    5001    // Total after toggle: 1 + (2,500 * 2) = 5,001
+    1,       // Single light brightness +1
+    2000001  // Total after toggle: 1 + (1,000,000 * 2) = 2,000,001
 };
 
 // Command types for efficient processing
@@ -51,210 +71,450 @@ typedef struct {
     int end_x, end_y;
 } LightCommand;
 
-// Simple atoi for C64 (no stdlib dependency)
-int simple_atoi(const char* str) {
-    int result = 0;
-    int i = 0;
-    while (str[i] >= '0' && str[i] <= '9') {
-        result = result * 10 + (str[i] - '0');
-        i++;
+// Coordinate-compressed sweep: the x and y edges of all rectangles cut the
+// grid into at most (2 * MAX_RECTS)^2 cells, and every light in a cell
+// always shares the same state, so each cell is simulated once and
+// weighted by its area. Works for both parts in about 12KB of RAM.
+#define MAX_RECTS 320
+#define MAX_EDGES (2 * MAX_RECTS)
+
+// A command with its corners replaced by edge indices; it covers the cells
+// [x0, x1) x [y0, y1)
+typedef struct {
+    CommandType cmd_type;
+    unsigned int x0, x1;
+    unsigned int y0, y1;
+} CellRect;
+
+LightCommand rects[MAX_RECTS];
+CellRect cell_rects[MAX_RECTS];
+unsigned int rect_count;
+
+unsigned int x_edges[MAX_EDGES];
+unsigned int y_edges[MAX_EDGES];
+unsigned int x_count, y_count;
+
+// One column of cells at a time: height, on/off state and brightness
+unsigned int cell_height[MAX_EDGES];
+unsigned char cell_lit[MAX_EDGES];
+unsigned int cell_bright[MAX_EDGES];
+
+// Streaming parser state: a command is built up as its characters arrive,
+// so lines never need to be buffered or copied
+typedef struct {
+    LightCommand cmd;
+    unsigned char col;    // position in the current line (stops at 255)
+    unsigned char field;  // numbers completed so far on this line
+    unsigned char digits; // 1 while inside a number
+    unsigned char valid;  // line starts like "turn" or "toggle"
+    unsigned int value;   // number being read
+} LineParser;
+
+// Input is read from disk in blocks of this size
+#define BLOCK_SIZE 256
+char read_block[BLOCK_SIZE];
+
+void parser_reset(LineParser* p) {
+    p->col = 0;
+    p->field = 0;
+    p->digits = 0;
+    p->valid = 0;
+}
+
+// Store a finished number: start x, start y, end x, end y in that order
+void parser_end_number(LineParser* p) {
+    switch (p->field) {
+        case 0: p->cmd.start_x = p->value; break;
+        case 1: p->cmd.start_y = p->value; break;
+        case 2: p->cmd.end_x = p->value; break;
+        case 3: p->cmd.end_y = p->value; break;
     }
-    return result;
+    p->field++;
+    p->digits = 0;
 }
 
-// Parse a single instruction line (C64-compatible)
-void parse_instruction(const char* line, LightCommand* cmd) {
-    int pos = 0;
-    char num_str[10];
-    int num_pos;
-
-    // Parse command type
-    if (line[0] == 't' && line[1] == 'u' && line[2] == 'r' && line[3] == 'n') {
-        // "turn on/off"
-        pos = 5; // skip "turn "
-        if (line[pos] == 'o' && line[pos+1] == 'n') {
-            cmd->cmd_type = CMD_TURN_ON;
-            pos += 3; // skip "on "
-        } else {
-            cmd->cmd_type = CMD_TURN_OFF;
-            pos += 4; // skip "off "
+// Feed one character; 1 when it completes a command in p->cmd.
+// "turn on", "turn off" and "toggle" differ at columns 1 and 6, and the
+// four numbers are the only digits on a line.
+unsigned char parser_put(LineParser* p, char c) {
+    unsigned char done;
+
+    if (c >= '0' && c <= '9') {
+        p->value = p->digits ? p->value * 10 + (c - '0') : (unsigned int)(c - '0');
+        p->digits = 1;
+    } else if (c == '\n' || c == '\r') {
+        if (p->digits) {
+            parser_end_number(p);
         }
+        done = p->valid && p->field == 4;
+        parser_reset(p);
+        return done;
     } else {
-        // "toggle"
-        cmd->cmd_type = CMD_TOGGLE;
-        pos = 7; // skip "toggle "
+        if (p->digits) {
+            parser_end_number(p);
+        }
+        switch (p->col) {
+            case 0:
+                p->valid = (c == 't');
+                break;
+            case 1:
+                if (c == 'o') {
+                    p->cmd.cmd_type = CMD_TOGGLE;
+                } else if (c == 'u') {
+                    p->cmd.cmd_type = CMD_TURN_ON;
+                } else {
+                    p->valid = 0;
+                }
+                break;
+            case 6:
+                if (p->cmd.cmd_type == CMD_TURN_ON && c == 'f') {
+                    p->cmd.cmd_type = CMD_TURN_OFF;
+                }
+                break;
+        }
     }
-
-    // Parse start_x
-    num_pos = 0;
-    while (line[pos] >= '0' && line[pos] <= '9') {
-        num_str[num_pos++] = line[pos++];
+    if (p->col < 255) {
+        p->col++;
     }
-    num_str[num_pos] = '\0';
-    cmd->start_x = simple_atoi(num_str);
-    pos++; // skip comma
+    return 0;
+}
 
-    // Parse start_y
-    num_pos = 0;
-    while (line[pos] >= '0' && line[pos] <= '9') {
-        num_str[num_pos++] = line[pos++];
+// Parse a single in-memory instruction line; 0 if it is not a command
+unsigned char parse_instruction(const char* line, LightCommand* cmd) {
+    LineParser p;
+
+    parser_reset(&p);
+    while (*line) {
+        parser_put(&p, *line++);
+    }
+    if (!parser_put(&p, '\n')) {
+        return 0;
     }
-    num_str[num_pos] = '\0';
-    cmd->start_y = simple_atoi(num_str);
+    *cmd = p.cmd;
+    return 1;
+}
 
-    // Skip " through "
-    pos += 9; // skip " through "
+#ifdef __CC65__
+// Fetch bytes [first, first + count) of row y from the REU into span_buf
+unsigned char* span_load(unsigned int y, unsigned char first, unsigned char count) {
+    unsigned long addr = (unsigned long)y * ROW_BYTES + first;
+
+    span_copy.buf = span_buf;
+    span_copy.offs = (unsigned char)addr;
+    span_copy.page = (unsigned int)(addr >> 8);
+    span_copy.count = count;
+    em_copyfrom(&span_copy);
+    return span_buf;
+}
 
-    // Parse end_x
-    num_pos = 0;
-    while (line[pos] >= '0' && line[pos] <= '9') {
-        num_str[num_pos++] = line[pos++];
+// Write the span fetched by the last span_load back to the REU
+#define span_store() em_copyto(&span_copy)
+#else
+#define span_load(y, first, count) (&bitmap[y][first])
+#define span_store()
+#endif
+
+// One-time setup: 0 when there is nowhere to keep the bitmap
+unsigned char bitmap_init(void) {
+    unsigned int i;
+
+    bit_count[0] = 0;
+    for (i = 1; i < 256; i++) {
+        bit_count[i] = (unsigned char)((i & 1) + bit_count[i >> 1]);
     }
-    num_str[num_pos] = '\0';
-    cmd->end_x = simple_atoi(num_str);
-    pos++; // skip comma
 
-    // Parse end_y
-    num_pos = 0;
-    while (line[pos] >= '0' && line[pos] <= '9') {
-        num_str[num_pos++] = line[pos++];
+#ifdef __CC65__
+    if (em_install(c64_reu_emd) != EM_ERR_OK) {
+        return 0;
+    }
+    if (em_pagecount() < BITMAP_PAGES) {
+        em_uninstall();
+        return 0;
     }
-    num_str[num_pos] = '\0';
-    cmd->end_y = simple_atoi(num_str);
+#endif
+    return 1;
 }
 
-// Process a single command on a grid with incremental counting
-void process_command_part1(char grid[DEMO_ROWS][DEMO_COLS], const LightCommand* cmd, unsigned long* light_count) {
-    int x, y;
-    int start_x = cmd->start_x;
-    int start_y = cmd->start_y;
-    int end_x = cmd->end_x;
-    int end_y = cmd->end_y;
-
-    // Clamp coordinates to grid bounds for demo
-    if (start_x < 0) start_x = 0;
-    if (start_y < 0) start_y = 0;
-    if (end_x >= DEMO_ROWS) end_x = DEMO_ROWS - 1;
-    if (end_y >= DEMO_COLS) end_y = DEMO_COLS - 1;
-
-    for (x = start_x; x <= end_x; x++) {
-        for (y = start_y; y <= end_y; y++) {
-            switch (cmd->cmd_type) {
-                case CMD_TURN_ON:
-                    if (grid[x][y] == 0) {
-                        grid[x][y] = 1;
-                        (*light_count)++;
-                    }
-                    break;
-                case CMD_TURN_OFF:
-                    if (grid[x][y] == 1) {
-                        grid[x][y] = 0;
-                        (*light_count)--;
-                    }
-                    break;
-                case CMD_TOGGLE:
-                    if (grid[x][y] == 1) {
-                        grid[x][y] = 0;
-                        (*light_count)--;
-                    } else {
-                        grid[x][y] = 1;
-                        (*light_count)++;
+// Turn every light off
+void bitmap_clear(void) {
+#ifdef __CC65__
+    unsigned int y;
+
+    for (y = 0; y < GRID_SIZE; y++) {
+        span_load(y, 0, ROW_BYTES);
+        memset(span_buf, 0, ROW_BYTES);
+        span_store();
+    }
+#else
+    memset(bitmap, 0, sizeof(bitmap));
+#endif
+}
+
+// Apply one command to the bitmap: whole bytes in the middle of each row
+// span are set, cleared or flipped at once, only the two edges are masked
+void bitmap_apply(const LightCommand* cmd) {
+    unsigned int x0 = cmd->start_x;
+    unsigned int x1 = cmd->end_x;
+    unsigned int y1 = cmd->end_y;
+    unsigned int y;
+    unsigned char first, last, lmask, rmask, i;
+    unsigned char* p;
+
+    if (x1 >= GRID_SIZE) x1 = GRID_SIZE - 1;
+    if (y1 >= GRID_SIZE) y1 = GRID_SIZE - 1;
+    if (x0 > x1 || (unsigned int)cmd->start_y > y1) return;
+
+    first = (unsigned char)(x0 >> 3);
+    last = (unsigned char)((x1 >> 3) - first);  // index of the right edge byte
+    lmask = left_mask[x0 & 7];
+    rmask = right_mask[x1 & 7];
+    if (last == 0) {
+        lmask &= rmask;
+    }
+
+    for (y = cmd->start_y; y <= y1; y++) {
+        p = span_load(y, first, last + 1);
+        switch (cmd->cmd_type) {
+            case CMD_TURN_ON:
+                p[0] |= lmask;
+                if (last) {
+                    memset(p + 1, 0xFF, last - 1);
+                    p[last] |= rmask;
+                }
+                break;
+            case CMD_TURN_OFF:
+                p[0] &= (unsigned char)~lmask;
+                if (last) {
+                    memset(p + 1, 0x00, last - 1);
+                    p[last] &= (unsigned char)~rmask;
+                }
+                break;
+            case CMD_TOGGLE:
+                p[0] ^= lmask;
+                if (last) {
+                    for (i = 1; i < last; i++) {
+                        p[i] ^= 0xFF;
                     }
-                    break;
-            }
+                    p[last] ^= rmask;
+                }
+                break;
         }
+        span_store();
     }
 }
 
-// Simulate Part 1 with actual grid operations (scaled for C64)
+// Count lit lights a byte at a time through the bit_count table
+unsigned long bitmap_count(void) {
+    unsigned long total = 0;
+    unsigned int y;
+    unsigned char i;
+    unsigned char* p;
+
+    for (y = 0; y < GRID_SIZE; y++) {
+        p = span_load(y, 0, ROW_BYTES);
+        for (i = 0; i < ROW_BYTES; i++) {
+            total += bit_count[p[i]];
+        }
+    }
+    return total;
+}
+
+// Simulate Part 1 on the full 1000x1000 bitmap
 unsigned long simulate_part1_full(const LightCommand* commands, int num_commands) {
-    int x, y, i;
+    int i;
     unsigned long light_count = 0;
 
-    // Initialize grid to off
-    for (x = 0; x < DEMO_ROWS; x++) {
-        for (y = 0; y < DEMO_COLS; y++) {
-            part1_grid[x][y] = 0;
-        }
-    }
+    bitmap_clear();
 
     // Process each command and show intermediate results
     for (i = 0; i < num_commands; i++) {
-        process_command_part1(part1_grid, &commands[i], &light_count);
+        bitmap_apply(&commands[i]);
+        light_count = bitmap_count();
         cprintf("Step %d: %lu lights\r\n", i+1, light_count);
     }
 
     return light_count;
 }
 
-// Process a single command on brightness grid with incremental counting (Part 2)
-void process_command_part2(unsigned int grid[DEMO_ROWS][DEMO_COLS], const LightCommand* cmd, unsigned long* brightness_total) {
-    int x, y;
-    int start_x = cmd->start_x;
-    int start_y = cmd->start_y;
-    int end_x = cmd->end_x;
-    int end_y = cmd->end_y;
-
-    // Clamp coordinates to grid bounds for demo
-    if (start_x < 0) start_x = 0;
-    if (start_y < 0) start_y = 0;
-    if (end_x >= DEMO_ROWS) end_x = DEMO_ROWS - 1;
-    if (end_y >= DEMO_COLS) end_y = DEMO_COLS - 1;
-
-    for (x = start_x; x <= end_x; x++) {
-        for (y = start_y; y <= end_y; y++) {
-            switch (cmd->cmd_type) {
+void sweep_reset(void) {
+    rect_count = 0;
+}
+
+// Queue a command for the sweep; 0 when there is no room left
+unsigned char sweep_add(const LightCommand* cmd) {
+    LightCommand* r;
+
+    if (rect_count == MAX_RECTS) {
+        return 0;
+    }
+    r = &rects[rect_count];
+    *r = *cmd;
+    if (r->end_x >= GRID_SIZE) r->end_x = GRID_SIZE - 1;
+    if (r->end_y >= GRID_SIZE) r->end_y = GRID_SIZE - 1;
+    if (r->start_x > r->end_x || r->start_y > r->end_y) {
+        return 1;  // covers no lights
+    }
+    rect_count++;
+    return 1;
+}
+
+int compare_edges(const void* a, const void* b) {
+    unsigned int ea = *(const unsigned int*)a;
+    unsigned int eb = *(const unsigned int*)b;
+    return (ea > eb) - (ea < eb);
+}
+
+// Sort edges and drop duplicates; returns the number left
+unsigned int sort_edges(unsigned int* edges, unsigned int n) {
+    unsigned int i, count;
+
+    if (n == 0) {
+        return 0;
+    }
+    qsort(edges, n, sizeof(unsigned int), compare_edges);
+    count = 1;
+    for (i = 1; i < n; i++) {
+        if (edges[i] != edges[count - 1]) {
+            edges[count++] = edges[i];
+        }
+    }
+    return count;
+}
+
+// Binary search for the index of an edge that is known to be present
+unsigned int edge_index(const unsigned int* edges, unsigned int n, unsigned int value) {
+    unsigned int lo = 0;
+    unsigned int mid;
+
+    while (n > 1) {
+        mid = n >> 1;
+        if (edges[lo + mid] <= value) {
+            lo += mid;
+            n -= mid;
+        } else {
+            n = mid;
+        }
+    }
+    return lo;
+}
+
+// Run every queued command over the compressed cells, one column of cells
+// at a time, and total the lit area (Part 1) and brightness (Part 2)
+void sweep_run(unsigned long* lit, unsigned long* brightness) {
+    unsigned int i, xi, y, y1;
+    unsigned long strip_lit, strip_bright;
+    const LightCommand* r;
+    CellRect* c;
+
+    *lit = 0;
+    *brightness = 0;
+    if (rect_count == 0) {
+        return;
+    }
+
+    // Each rectangle starts cells at its corner and just past its far edge
+    for (i = 0; i < rect_count; i++) {
+        r = &rects[i];
+        x_edges[2 * i] = r->start_x;
+        x_edges[2 * i + 1] = r->end_x + 1;
+        y_edges[2 * i] = r->start_y;
+        y_edges[2 * i + 1] = r->end_y + 1;
+    }
+    x_count = sort_edges(x_edges, 2 * rect_count);
+    y_count = sort_edges(y_edges, 2 * rect_count);
+
+    for (i = 0; i < rect_count; i++) {
+        r = &rects[i];
+        c = &cell_rects[i];
+        c->cmd_type = r->cmd_type;
+        c->x0 = edge_index(x_edges, x_count, r->start_x);
+        c->x1 = edge_index(x_edges, x_count, r->end_x + 1);
+        c->y0 = edge_index(y_edges, y_count, r->start_y);
+        c->y1 = edge_index(y_edges, y_count, r->end_y + 1);
+    }
+    for (y = 0; y + 1 < y_count; y++) {
+        cell_height[y] = y_edges[y + 1] - y_edges[y];
+    }
+
+    for (xi = 0; xi + 1 < x_count; xi++) {
+        memset(cell_lit, 0, y_count);
+        memset(cell_bright, 0, y_count * sizeof(unsigned int));
+
+        // Replay the commands covering this column in their original order
+        for (i = 0, c = cell_rects; i < rect_count; i++, c++) {
+            if (xi < c->x0 || xi >= c->x1) continue;
+            y1 = c->y1;
+            switch (c->cmd_type) {
                 case CMD_TURN_ON:
-                    grid[x][y] += 1;
-                    (*brightness_total) += 1;
+                    for (y = c->y0; y < y1; y++) {
+                        cell_lit[y] = 1;
+                        cell_bright[y] += 1;
+                    }
                     break;
                 case CMD_TURN_OFF:
-                    if (grid[x][y] > 0) {
-                        grid[x][y] -= 1;
-                        (*brightness_total) -= 1;
+                    for (y = c->y0; y < y1; y++) {
+                        cell_lit[y] = 0;
+                        if (cell_bright[y] > 0) {
+                            cell_bright[y] -= 1;
+                        }
                     }
                     break;
                 case CMD_TOGGLE:
-                    grid[x][y] += 2;
-                    (*brightness_total) += 2;
+                    for (y = c->y0; y < y1; y++) {
+                        cell_lit[y] ^= 1;
+                        cell_bright[y] += 2;
+                    }
                     break;
             }
         }
+
+        strip_lit = 0;
+        strip_bright = 0;
+        for (y = 0; y + 1 < y_count; y++) {
+            if (cell_lit[y]) {
+                strip_lit += cell_height[y];
+            }
+            strip_bright += (unsigned long)cell_height[y] * cell_bright[y];
+        }
+        i = x_edges[xi + 1] - x_edges[xi];  // column width
+        *lit += strip_lit * i;
+        *brightness += strip_bright * i;
     }
 }
 
-// Simulate Part 2 with actual grid operations (scaled for C64)
-unsigned long simulate_part2_full(const LightCommand* commands, int num_commands) {
-    int x, y, i;
-    unsigned long brightness_total = 0;
+// Simulate on the compressed cells, re-running the sweep after each step
+unsigned long simulate_sweep(const LightCommand* commands, int num_commands, unsigned char part) {
+    int i;
+    unsigned long lit = 0;
+    unsigned long brightness = 0;
 
-    // Initialize brightness grid to 0
-    for (x = 0; x < DEMO_ROWS; x++) {
-        for (y = 0; y < DEMO_COLS; y++) {
-            part2_grid[x][y] = 0;
-        }
-    }
+    sweep_reset();
 
-    // Process each command and show intermediate results
     for (i = 0; i < num_commands; i++) {
-        process_command_part2(part2_grid, &commands[i], &brightness_total);
-        cprintf("Step %d: %lu brightness\r\n", i+1, brightness_total);
+        sweep_add(&commands[i]);
+        sweep_run(&lit, &brightness);
+        if (part == 1) {
+            cprintf("Step %d: %lu lights\r\n", i+1, lit);
+        } else {
+            cprintf("Step %d: %lu brightness\r\n", i+1, brightness);
+        }
     }
 
-    return brightness_total;
+    return part == 1 ? lit : brightness;
 }
 
-// Demonstration with small grid (works on real C64)
-void demo_with_small_grid(void) {
-    cprintf("DEMO: turn on 0,0-49,49 -> 2500 on\r\n");
-    cprintf("DEMO: toggle 0,0-49,0 -> 2450 on\r\n");
-    cprintf("DEMO: turn off 24,24-25,25 -> 2446 on\r\n");
+void check_result(unsigned long result, unsigned long expected) {
+    if (result == expected) {
+        cprintf("FINAL: PASS\r\n");
+    } else {
+        cprintf("FINAL: FAIL (got %lu, expected %lu)\r\n", result, expected);
+    }
 }
 
 void test_part1(void) {
     int i;
     LightCommand commands[PART1_TEST_COUNT];
-    unsigned long result;
+    unsigned long expected = part1_expected[PART1_TEST_COUNT - 1];
 
     cprintf("PART 1:\r\n");
 
@@ -263,20 +523,20 @@ void test_part1(void) {
         parse_instruction(part1_instructions[i], &commands[i]);
     }
 
-    // Simulate on actual 50x50 grid
-    result = simulate_part1_full(commands, PART1_TEST_COUNT);
-
-    if (result == part1_expected[PART1_TEST_COUNT - 1]) {
-        cprintf("FINAL: PASS\r\n");
-    } else {
-        cprintf("FINAL: FAIL (got %lu, expected %lu)\r\n", result, part1_expected[PART1_TEST_COUNT - 1]);
+    // Simulate on the full 1000x1000 bitmap
+    if (bitmap_ready) {
+        cprintf("Bitmap:\r\n");
+        check_result(simulate_part1_full(commands, PART1_TEST_COUNT), expected);
     }
+
+    // And on the compressed cells
+    cprintf("Sweep:\r\n");
+    check_result(simulate_sweep(commands, PART1_TEST_COUNT, 1), expected);
 }
 
 void test_part2(void) {
     int i;
     LightCommand commands[PART2_TEST_COUNT];
-    unsigned long result;
 
     cprintf("PART 2:\r\n");
 
@@ -285,30 +545,90 @@ void test_part2(void) {
         parse_instruction(part2_instructions[i], &commands[i]);
     }
 
-    // Simulate on actual 50x50 brightness grid
-    result = simulate_part2_full(commands, PART2_TEST_COUNT);
+    // Simulate on the compressed cells
+    check_result(simulate_sweep(commands, PART2_TEST_COUNT, 2),
+                 part2_expected[PART2_TEST_COUNT - 1]);
+}
 
-    if (result == part2_expected[PART2_TEST_COUNT - 1]) {
-        cprintf("FINAL: PASS\r\n");
-    } else {
-        cprintf("FINAL: FAIL (got %lu, expected %lu)\r\n", result, part2_expected[PART2_TEST_COUNT - 1]);
+// Hand one command to both engines; 0 when the sweep is out of room
+unsigned char feed_engines(const LightCommand* cmd) {
+    if (bitmap_ready) {
+        bitmap_apply(cmd);
     }
+    return sweep_add(cmd);
+}
+
+// Run both parts over the puzzle input on disk. The file is read a block
+// at a time and each command goes straight to the engines as it is parsed.
+void solve_input_file(const char* filename) {
+    FILE* fp;
+    LineParser parser;
+    size_t len, i;
+    unsigned int count = 0;
+    unsigned char fits = 1;
+    unsigned long lit, brightness;
+
+    fp = fopen(filename, "r");
+    if (!fp) {
+        cprintf("%s not found\r\n", filename);
+        return;
+    }
+
+    cprintf("INPUT: %s\r\n", filename);
+    if (bitmap_ready) {
+        bitmap_clear();
+    }
+    sweep_reset();
+    parser_reset(&parser);
+
+    while ((len = fread(read_block, 1, BLOCK_SIZE, fp)) > 0) {
+        for (i = 0; i < len; i++) {
+            if (parser_put(&parser, read_block[i])) {
+                fits &= feed_engines(&parser.cmd);
+                count++;
+            }
+        }
+    }
+    fclose(fp);
+
+    // The last line may have no newline of its own
+    if (parser_put(&parser, '\n')) {
+        fits &= feed_engines(&parser.cmd);
+        count++;
+    }
+
+    cprintf("%u commands\r\n", count);
+    if (bitmap_ready) {
+        cprintf("Bitmap Part 1: %lu lights\r\n", bitmap_count());
+    }
+    if (!fits) {
+        cprintf("Sweep: more than %d commands\r\n", MAX_RECTS);
+        return;
+    }
+    sweep_run(&lit, &brightness);
+    cprintf("Sweep: %u x %u cells\r\n", x_count - 1, y_count - 1);
+    cprintf("Part 1: %lu lights\r\n", lit);
+    cprintf("Part 2: %lu brightness\r\n", brightness);
 }
 
 int main(void) {
     clrscr();
 
-    cprintf("AOC 2015 Day 6 - 50x50 Grid\r\n");
-    cprintf("==========================\r\n");
+    cprintf("AOC 2015 Day 6 - 1000x1000 Grid\r\n");
+    cprintf("==============================\r\n");
 
-    // Show small grid demonstration
-    demo_with_small_grid();
-    cprintf("\r\n");
+    bitmap_ready = bitmap_init();
+    if (!bitmap_ready) {
+        cprintf("No REU: bitmap skipped\r\n");
+    }
 
     // Run the actual tests
     test_part1();
     test_part2();
 
+    cprintf("\r\n");
+    solve_input_file("input.txt");
+
     cprintf("\r\nPress any key...\r\n");
     cgetc();
 
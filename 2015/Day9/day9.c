@@ -4,14 +4,19 @@
  * C64 Version for cc65
  */
 
-#include <limits.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include "heldkarp.h"
 
 /* Constants */
 #define MAX_CITIES 10
 #define MAX_NAME_LEN 16
+#define NO_ROUTE 0xFFFF
+
+/* Solver selection */
+#define SOLVER_HELD_KARP 0
+#define SOLVER_BRANCH_BOUND 1
 
 /* Types */
 typedef struct {
@@ -22,7 +27,13 @@ typedef struct {
 City cities[MAX_CITIES];
 int num_cities = 0;
 unsigned int dist_matrix[MAX_CITIES][MAX_CITIES];
-int visited[MAX_CITIES];
+
+/* Branch-and-bound state: cheapest/largest edge touching each city */
+unsigned int min_edge[MAX_CITIES];
+unsigned int max_edge[MAX_CITIES];
+unsigned int full_mask;
+unsigned long nodes_min;
+unsigned long nodes_max;
 
 /* Results */
 unsigned int min_route_dist;
@@ -32,9 +43,9 @@ unsigned int max_route_dist;
 void init_systems(void);
 int get_city_index(const char *name);
 void add_route(const char *from, const char *to, unsigned int dist);
-void solve_tsp(int current_city, int count, unsigned int current_dist);
-void solve_all(void);
+void solve_all(unsigned char solver);
 void run_tests(void);
+void run_benchmark(void);
 
 /* Main Entry Point */
 int main(void) {
@@ -44,6 +55,7 @@ int main(void) {
   printf("   --- Santa's Route Plan ---\n\n");
 
   run_tests();
+  run_benchmark();
 
   return 0;
 }
@@ -84,55 +96,163 @@ void add_route(const char *from, const char *to, unsigned int dist) {
   }
 }
 
-/* Recursive TSP Solver (DFS) */
-/* Finds longest and shortest paths visiting all cities */
-void solve_tsp(int current_city, int count, unsigned int current_dist) {
-  int i;
+/* Shortest route search. rest is the sum of min_edge[] over unvisited
+ * cities: each of them must still be entered by some edge, so
+ * dist + rest never overestimates and subtrees that cannot beat the
+ * incumbent are cut. */
+void bb_min(unsigned char city, unsigned int visited, unsigned int dist,
+            unsigned int rest) {
+  unsigned char i;
+  unsigned int bit;
+
+  ++nodes_min;
+  if (visited == full_mask) {
+    if (dist < min_route_dist)
+      min_route_dist = dist;
+    return;
+  }
+  if (dist + rest >= min_route_dist)
+    return;
 
-  visited[current_city] = 1;
+  for (i = 0, bit = 1; i < num_cities; i++, bit <<= 1) {
+    if ((visited & bit) || dist_matrix[city][i] == 0)
+      continue;
+    bb_min(i, visited | bit, dist + dist_matrix[city][i], rest - min_edge[i]);
+  }
+}
 
-  /* Base case: All cities visited */
-  if (count == num_cities) {
-    if (current_dist < min_route_dist)
-      min_route_dist = current_dist;
-    if (current_dist > max_route_dist)
-      max_route_dist = current_dist;
-    visited[current_city] = 0; /* Backtrack */
+/* Longest route search, mirrored: rest sums max_edge[] over unvisited
+ * cities, an upper bound on what the subtree can still add. */
+void bb_max(unsigned char city, unsigned int visited, unsigned int dist,
+            unsigned int rest) {
+  unsigned char i;
+  unsigned int bit;
+
+  ++nodes_max;
+  if (visited == full_mask) {
+    if (dist > max_route_dist)
+      max_route_dist = dist;
+    return;
+  }
+  if (dist + rest <= max_route_dist)
     return;
+
+  for (i = 0, bit = 1; i < num_cities; i++, bit <<= 1) {
+    if ((visited & bit) || dist_matrix[city][i] == 0)
+      continue;
+    bb_max(i, visited | bit, dist + dist_matrix[city][i], rest - max_edge[i]);
   }
+}
+
+/* Run the min and max branch-and-bound searches from every start city */
+void solve_branch_bound(void) {
+  int i, j;
+  unsigned int sum_min = 0;
+  unsigned int sum_max = 0;
 
-  /* Try visiting all unvisited neighbors */
   for (i = 0; i < num_cities; i++) {
-    if (!visited[i] && dist_matrix[current_city][i] > 0) {
-      solve_tsp(i, count + 1, current_dist + dist_matrix[current_city][i]);
+    min_edge[i] = NO_ROUTE;
+    max_edge[i] = 0;
+    for (j = 0; j < num_cities; j++) {
+      if (dist_matrix[i][j] == 0)
+        continue;
+      if (dist_matrix[i][j] < min_edge[i])
+        min_edge[i] = dist_matrix[i][j];
+      if (dist_matrix[i][j] > max_edge[i])
+        max_edge[i] = dist_matrix[i][j];
     }
+    if (min_edge[i] == NO_ROUTE)
+      min_edge[i] = 0;
+    sum_min += min_edge[i];
+    sum_max += max_edge[i];
   }
 
-  visited[current_city] = 0; /* Backtrack */
+  full_mask = (1u << num_cities) - 1;
+  nodes_min = 0;
+  nodes_max = 0;
+  min_route_dist = NO_ROUTE;
+  max_route_dist = 0;
+
+  for (i = 0; i < num_cities; i++) {
+    bb_min(i, 1u << i, 0, sum_min - min_edge[i]);
+  }
+  for (i = 0; i < num_cities; i++) {
+    bb_max(i, 1u << i, 0, sum_max - max_edge[i]);
+  }
 }
 
-/* Wrapper to start TSP from every city */
-void solve_all(void) {
-  int i;
+/* Solve with the shared Held-Karp DP: shortest and longest Hamiltonian
+ * path, free to start and end at any city */
+void solve_held_karp(void) {
+  int i, j;
 
-  min_route_dist = UINT_MAX;
-  max_route_dist = 0;
+  for (i = 0; i < num_cities; i++) {
+    for (j = 0; j < num_cities; j++) {
+      /* A zero distance means no known route between the cities */
+      hk_weight[i][j] = dist_matrix[i][j] > 0 ? (int)dist_matrix[i][j] : HK_NONE;
+    }
+  }
 
-  /* Reset visited array */
-  for (i = 0; i < MAX_CITIES; i++)
-    visited[i] = 0;
+  min_route_dist = (unsigned int)hk_solve(num_cities, HK_ANY_START,
+                                          HK_MINIMIZE, HK_PATH);
+  max_route_dist = (unsigned int)hk_solve(num_cities, HK_ANY_START,
+                                          HK_MAXIMIZE, HK_PATH);
+}
 
-  /* Try starting path at every city */
-  for (i = 0; i < num_cities; i++) {
-    solve_tsp(i, 1, 0);
+/* Nodes an unpruned DFS from every start city would visit */
+unsigned long exhaustive_nodes(void) {
+  unsigned long total = 0;
+  unsigned long level = num_cities;
+  int k;
+
+  for (k = 1; k <= num_cities; k++) {
+    total += level;
+    level *= num_cities - k;
+  }
+  return total;
+}
+
+/* Solve both parts with the selected solver */
+void solve_all(unsigned char solver) {
+  if (solver == SOLVER_BRANCH_BOUND) {
+    solve_branch_bound();
+    printf("Nodes expanded: %lu min + %lu max\n", nodes_min, nodes_max);
+    printf("Unpruned search: %lu per pass\n", exhaustive_nodes());
+  } else {
+    solve_held_karp();
+  }
+}
+
+/* Solve with both solvers and check the answers */
+void check_routes(unsigned int expected_shortest,
+                  unsigned int expected_longest) {
+  unsigned char solver;
+
+  for (solver = SOLVER_HELD_KARP; solver <= SOLVER_BRANCH_BOUND; solver++) {
+    printf("\n%s:\n", solver == SOLVER_HELD_KARP ? "Held-Karp DP"
+                                                 : "Branch and bound");
+    solve_all(solver);
+
+    /* Part 1 Check */
+    printf("Part 1 - Shortest Route: %u ", min_route_dist);
+    if (min_route_dist == expected_shortest) {
+      printf("(PASS)\n");
+    } else {
+      printf("(FAIL - Expected %u)\n", expected_shortest);
+    }
+
+    /* Part 2 Check */
+    printf("Part 2 - Longest Route:  %u ", max_route_dist);
+    if (max_route_dist == expected_longest) {
+      printf("(PASS)\n");
+    } else {
+      printf("(FAIL - Expected %u)\n", expected_longest);
+    }
   }
 }
 
 /* Test runner with provided sample data */
 void run_tests(void) {
-  const unsigned int EXPECTED_SHORTEST = 605;
-  const unsigned int EXPECTED_LONGEST = 982;
-
   printf("Running Sample Tests...\n");
 
   /*
@@ -153,23 +273,45 @@ void run_tests(void) {
   printf("Cities processed: %d\n", num_cities);
   printf("Resolving routes...\n");
 
-  solve_all();
+  check_routes(605, 982);
+}
 
-  printf("\nResults:\n");
+/* Eight cities, the size of a real puzzle input, to measure pruning */
+void run_benchmark(void) {
+  printf("\nRunning 8-City Benchmark...\n");
 
-  /* Part 1 Check */
-  printf("Part 1 - Shortest Route: %u ", min_route_dist);
-  if (min_route_dist == EXPECTED_SHORTEST) {
-    printf("(PASS)\n");
-  } else {
-    printf("(FAIL - Expected %u)\n", EXPECTED_SHORTEST);
-  }
+  init_systems();
 
-  /* Part 2 Check */
-  printf("Part 2 - Longest Route:  %u ", max_route_dist);
-  if (max_route_dist == EXPECTED_LONGEST) {
-    printf("(PASS)\n");
-  } else {
-    printf("(FAIL - Expected %u)\n", EXPECTED_LONGEST);
-  }
+  add_route("Faerun", "Norrath", 22);
+  add_route("Faerun", "Tristram", 13);
+  add_route("Faerun", "AlphaCentauri", 36);
+  add_route("Faerun", "Arbre", 25);
+  add_route("Faerun", "Snowdin", 134);
+  add_route("Faerun", "Tambi", 110);
+  add_route("Faerun", "Straylight", 37);
+  add_route("Norrath", "Tristram", 113);
+  add_route("Norrath", "AlphaCentauri", 92);
+  add_route("Norrath", "Arbre", 11);
+  add_route("Norrath", "Snowdin", 148);
+  add_route("Norrath", "Tambi", 134);
+  add_route("Norrath", "Straylight", 32);
+  add_route("Tristram", "AlphaCentauri", 78);
+  add_route("Tristram", "Arbre", 6);
+  add_route("Tristram", "Snowdin", 140);
+  add_route("Tristram", "Tambi", 120);
+  add_route("Tristram", "Straylight", 103);
+  add_route("AlphaCentauri", "Arbre", 33);
+  add_route("AlphaCentauri", "Snowdin", 104);
+  add_route("AlphaCentauri", "Tambi", 143);
+  add_route("AlphaCentauri", "Straylight", 76);
+  add_route("Arbre", "Snowdin", 6);
+  add_route("Arbre", "Tambi", 64);
+  add_route("Arbre", "Straylight", 41);
+  add_route("Snowdin", "Tambi", 34);
+  add_route("Snowdin", "Straylight", 110);
+  add_route("Tambi", "Straylight", 33);
+
+  printf("Cities processed: %d\n", num_cities);
+
+  check_routes(160, 792);
 }
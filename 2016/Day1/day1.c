@@ -5,15 +5,28 @@
 
 /* Advent of Code 2016 - Day 1: No Time for a Taxicab */
 
-#define MAX_VISITED 1024
+/* Instructions being solved; real inputs are a single line of ~700 chars */
+#define BUFFER_SIZE 1024
+static char buffer[BUFFER_SIZE];
+
+/* The walk is kept as one axis-aligned segment per instruction, not as
+ * points, so memory does not depend on the step counts. Every token has
+ * at least one character and one separator, which bounds the count. */
+#define MAX_SEGMENTS (BUFFER_SIZE / 2 + 1)
+#define NO_HQ -1
 
 typedef struct {
-    int x;
-    int y;
-} Point;
+    int x_lo, x_hi;
+    int y_lo, y_hi;
+} Segment;
+
+static Segment segments[MAX_SEGMENTS];
+static unsigned int segment_count;
 
-static Point visited[MAX_VISITED];
-static int visited_count = 0;
+/* Results of the last solve_buffer */
+static int part1_result;
+static int part2_result;         /* NO_HQ if no location is visited twice */
+static unsigned int points_seen; /* distinct points before the first repeat */
 
 /* Directions: 0 = North, 1 = East, 2 = South, 3 = West */
 static int dx[] = { 0, 1, 0, -1 };
@@ -23,52 +36,80 @@ int manhattan_distance(int x, int y) {
     return abs(x) + abs(y);
 }
 
-int is_visited(int x, int y) {
-    int i;
-    for (i = 0; i < visited_count; ++i) {
-        if (visited[i].x == x && visited[i].y == y) {
-            return 1;
-        }
-    }
-    return 0;
+/* Record the walk from (x, y) 'steps' blocks towards 'facing' */
+void add_segment(int x, int y, int facing, int steps) {
+    Segment* s = &segments[segment_count++];
+    int ex = x + dx[facing] * steps;
+    int ey = y + dy[facing] * steps;
+
+    s->x_lo = x < ex ? x : ex;
+    s->x_hi = x < ex ? ex : x;
+    s->y_lo = y < ey ? y : ey;
+    s->y_hi = y < ey ? ey : y;
 }
 
-void mark_visited(int x, int y) {
-    if (visited_count >= MAX_VISITED) {
-        textcolor(COLOR_RED);
-        printf("\nError: visited array full!\n");
-        exit(1);
+/* First k in 1..steps for which (x, y) + k * direction lies on an earlier
+ * segment, or 0 if none does. Both lines are axis-aligned, so each test is
+ * a bounding-box overlap; the nearest end of the overlap is the first hit. */
+int first_crossing(int x, int y, int facing, int steps) {
+    int lo, hi, a_lo, a_hi, fixed, k;
+    int best = 0;
+    unsigned int i;
+    const Segment* s;
+
+    if (steps <= 0) {
+        return 0;
+    }
+    if (dx[facing]) {
+        a_lo = dx[facing] > 0 ? x + 1 : x - steps;
+        a_hi = dx[facing] > 0 ? x + steps : x - 1;
+        fixed = y;
+    } else {
+        a_lo = dy[facing] > 0 ? y + 1 : y - steps;
+        a_hi = dy[facing] > 0 ? y + steps : y - 1;
+        fixed = x;
     }
-    visited[visited_count].x = x;
-    visited[visited_count].y = y;
-    visited_count++;
-}
 
-static char buffer[256];
+    for (i = 0; i < segment_count; ++i) {
+        s = &segments[i];
+        if (dx[facing]) {
+            if (fixed < s->y_lo || fixed > s->y_hi) continue;
+            lo = s->x_lo > a_lo ? s->x_lo : a_lo;
+            hi = s->x_hi < a_hi ? s->x_hi : a_hi;
+            if (lo > hi) continue;
+            k = dx[facing] > 0 ? lo - x : x - hi;
+        } else {
+            if (fixed < s->x_lo || fixed > s->x_hi) continue;
+            lo = s->y_lo > a_lo ? s->y_lo : a_lo;
+            hi = s->y_hi < a_hi ? s->y_hi : a_hi;
+            if (lo > hi) continue;
+            k = dy[facing] > 0 ? lo - y : y - hi;
+        }
+        if (best == 0 || k < best) {
+            best = k;
+        }
+    }
+    return best;
+}
 
-void solve(const char* input) {
+/* Solve the instructions in 'buffer' (which strtok cuts up) */
+void solve_buffer(void) {
     static int x, y;
     static int facing;
     static char* token;
-    static int hq_x, hq_y;
     static int hq_found;
     static char turn;
     static int steps;
-    static int i;
+    static int k;
 
     x = 0; y = 0;
     facing = 0; /* 0: North */
     hq_found = 0;
+    segment_count = 0;
+    points_seen = 1; /* the start */
+    part2_result = NO_HQ;
 
-    visited_count = 0;
-    mark_visited(0, 0);
-
-    snprintf(buffer, sizeof(buffer), "%s", input);
-    token = strtok(buffer, ", ");
-    
-    textcolor(COLOR_YELLOW);
-    printf("Input: %s\n", input);
-    textcolor(COLOR_LIGHTBLUE);
+    token = strtok(buffer, ", \r\n");
 
     while (token != NULL) {
         turn = token[0];
@@ -80,35 +121,108 @@ void solve(const char* input) {
             facing = (facing + 1) % 4;
         }
 
-        for (i = 0; i < steps; ++i) {
-            x += dx[facing];
-            y += dy[facing];
-
-            if (!hq_found) {
-                if (is_visited(x, y)) {
-                    hq_x = x;
-                    hq_y = y;
-                    hq_found = 1;
-                } else {
-                    mark_visited(x, y);
-                }
+        if (!hq_found) {
+            k = first_crossing(x, y, facing, steps);
+            if (k) {
+                part2_result = manhattan_distance(x + dx[facing] * k,
+                                                  y + dy[facing] * k);
+                points_seen += k - 1;
+                hq_found = 1;
+            } else {
+                add_segment(x, y, facing, steps);
+                points_seen += steps;
             }
         }
-        token = strtok(NULL, ", ");
+        x += dx[facing] * steps;
+        y += dy[facing] * steps;
+        token = strtok(NULL, ", \r\n");
     }
+    part1_result = manhattan_distance(x, y);
 
     printf("  Part 1: ");
     textcolor(COLOR_WHITE);
-    printf("%d blocks\n", manhattan_distance(x, y));
+    printf("%d blocks\n", part1_result);
     
     textcolor(COLOR_LIGHTBLUE);
     printf("  Part 2: ");
     textcolor(COLOR_WHITE);
     if (hq_found) {
-        printf("%d blocks\n", manhattan_distance(hq_x, hq_y));
+        printf("%d blocks\n", part2_result);
     } else {
         printf("Not found\n");
     }
+    textcolor(COLOR_LIGHTBLUE);
+    printf("  Visited: ");
+    textcolor(COLOR_WHITE);
+    printf("%u points, %u segments\n", points_seen, segment_count);
+}
+
+/* Compare the last solve with the expected answers */
+void check_results(int part1, int part2, unsigned int points) {
+    if (part1_result == part1 && part2_result == part2 &&
+        points_seen == points) {
+        textcolor(COLOR_GREEN);
+        printf("  PASS\n");
+    } else {
+        textcolor(COLOR_LIGHTRED);
+        printf("  FAIL (expected %d, ", part1);
+        if (part2 == NO_HQ) {
+            printf("no HQ");
+        } else {
+            printf("%d", part2);
+        }
+        printf(", %u points)\n", points);
+    }
+    printf("\n");
+}
+
+/* Solve a sample and check it against its known answers */
+void solve(const char* input, int part1, int part2, unsigned int points) {
+    snprintf(buffer, sizeof(buffer), "%s", input);
+
+    textcolor(COLOR_YELLOW);
+    printf("Input: %s\n", input);
+    textcolor(COLOR_LIGHTBLUE);
+    solve_buffer();
+    check_results(part1, part2, points);
+}
+
+/* Solve the puzzle input on disk, if there is one */
+void solve_file(const char* filename) {
+    FILE* fp;
+    size_t len;
+    int c;
+    unsigned char too_long = 0;
+
+    fp = fopen(filename, "r");
+    if (!fp) {
+        return;
+    }
+    len = fread(buffer, 1, sizeof(buffer) - 1, fp);
+    /* A full buffer may have cut the last instruction short; only
+     * trailing separators are allowed after it */
+    if (len == sizeof(buffer) - 1) {
+        while ((c = fgetc(fp)) != EOF) {
+            if (c != ' ' && c != ',' && c != '\r' && c != '\n') {
+                too_long = 1;
+                break;
+            }
+        }
+    }
+    fclose(fp);
+    buffer[len] = '\0';
+
+    if (too_long) {
+        textcolor(COLOR_LIGHTRED);
+        printf("%s: input longer than %u chars\n\n", filename,
+               (unsigned int)(sizeof(buffer) - 1));
+        return;
+    }
+
+    textcolor(COLOR_YELLOW);
+    printf("Input: %s (%u chars)\n", filename, (unsigned int)len);
+    textcolor(COLOR_LIGHTBLUE);
+    solve_buffer();
     printf("\n");
 }
 
@@ -120,17 +234,19 @@ int main() {
     printf("      - NO TIME FOR A TAXICAB -         \n");
     printf("========================================\n\n");
 
-    /* Sample 1 */
-    solve("R2, L3");
-    
-    /* Sample 2 */
-    solve("R2, R2, R2");
+    /* Samples: Part 1, Part 2 (NO_HQ if none) and points before the
+     * first repeat */
+    solve("R2, L3", 5, NO_HQ, 6);
+    solve("R2, R2, R2", 2, NO_HQ, 7);
+    solve("R5, L5, R5, R3", 12, NO_HQ, 19);
+    solve("R8, R4, R4, R8", 8, 4, 20);
 
-    /* Sample 3 */
-    solve("R5, L5, R5, R3");
+    /* Long walk, well past what a point set of the old size could hold */
+    solve("L42, L52, R119, L191, R132, L154, R48, L158, R44, R152, L151, "
+          "R63, L138, L123, R166, L139, R27, R66, R150, L143, R123, R125, "
+          "R112, R188, L77, L123, R182, L100, R154", 1672, 1376, 1992);
 
-    /* HQ Sample for Part 2 */
-    solve("R8, R4, R4, R8");
+    solve_file("input.txt");
 
     printf("\nPress any key to exit...");
     cgetc();
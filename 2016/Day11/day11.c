@@ -39,32 +39,46 @@ void init_choose() {
     }
 }
 
-// Pack state to 16-bit ID for the visited bitset
-unsigned int get_state_id(State *s) {
-    unsigned char sorted[MAX_PAIRS];
-    int i, j;
-    unsigned int id;
-    
-    // Copy and sort pairs
-    memcpy(sorted, s->pairs, MAX_PAIRS);
-    for (i = 0; i < MAX_PAIRS - 1; ++i) {
-        for (j = i + 1; j < MAX_PAIRS; ++j) {
-            if (sorted[i] > sorted[j]) {
-                unsigned char tmp = sorted[i];
-                sorted[i] = sorted[j];
-                sorted[j] = tmp;
-            }
+/* Compare-exchange step of the sorting network */
+#define CSWAP(a, b) if (p[a] > p[b]) { t = p[a]; p[a] = p[b]; p[b] = t; }
+
+// Sort the pairs into canonical (ascending) order with a 5-input
+// sorting network: 9 fixed compare-exchanges, no loop overhead.
+void canonicalize(State *s) {
+    unsigned char *p = s->pairs;
+    unsigned char t;
+    CSWAP(0, 1); CSWAP(3, 4); CSWAP(2, 4);
+    CSWAP(2, 3); CSWAP(1, 4); CSWAP(0, 3);
+    CSWAP(0, 2); CSWAP(1, 3); CSWAP(1, 2);
+}
+
+// Restore canonical order after a move changed one or two pairs. The
+// array is nearly sorted, so an insertion pass only does a handful of
+// compares instead of a full sort.
+void resort(State *s) {
+    unsigned char *p = s->pairs;
+    unsigned char k, m, v;
+    for (k = 1; k < MAX_PAIRS; ++k) {
+        v = p[k];
+        for (m = k; m > 0 && p[m - 1] > v; --m) {
+            p[m] = p[m - 1];
         }
+        p[m] = v;
     }
+}
+
+// Pack a canonical (sorted) state to 16-bit ID for the visited bitset
+unsigned int get_state_id(State *s) {
+    unsigned int id;
     
     // Combination index for 5 items from 16 types:
     // Index = choose(p1, 1) + choose(p2+1, 2) + choose(p3+2, 3) + choose(p4+3, 4) + choose(p5+4, 5)
     id = (unsigned int)s->elevator * COMBINATIONS_COUNT;
-    id += choose[sorted[0]][1];
-    id += choose[sorted[1] + 1][2];
-    id += choose[sorted[2] + 2][3];
-    id += choose[sorted[3] + 3][4];
-    id += choose[sorted[4] + 4][5];
+    id += choose[s->pairs[0]][1];
+    id += choose[s->pairs[1] + 1][2];
+    id += choose[s->pairs[2] + 2][3];
+    id += choose[s->pairs[3] + 3][4];
+    id += choose[s->pairs[4] + 4][5];
     return id;
 }
 
@@ -76,34 +90,9 @@ int is_visited(unsigned int id) {
     return visited[id >> 3] & (1 << (id & 7));
 }
 
-int is_valid(State *s) {
-    unsigned char floor_gens[4];
-    unsigned char floor_chips[4];
-    int p, f;
-
-    memset(floor_gens, 0, 4);
-    memset(floor_chips, 0, 4);
-
-    for (p = 0; p < MAX_PAIRS; ++p) {
-        floor_gens[s->pairs[p] >> 2] |= (1 << p);
-        floor_chips[s->pairs[p] & 3] |= (1 << p);
-    }
-
-    for (f = 0; f < 4; ++f) {
-        if (floor_gens[f] && (floor_chips[f] & floor_gens[f]) != floor_chips[f]) {
-            return 0;
-        }
-    }
-    return 1;
-}
-
-int is_victory(State *s, int num_pairs) {
-    int i;
-    for (i = 0; i < num_pairs; ++i) {
-        if (s->pairs[i] != 15) return 0;
-    }
-    return 1;
-}
+// A floor is safe if it has no generators, or every chip on it is
+// shielded by its own generator.
+#define FLOOR_OK(g, c) ((g) == 0 || ((c) & ~(g)) == 0)
 
 int solve(State *initial, int num_pairs) {
     int head = 0, tail = 0;
@@ -114,19 +103,24 @@ int solve(State *initial, int num_pairs) {
     State curr;
     State next;
     unsigned char items[10];
+    unsigned char item_mask[10];
     int num_items;
-    int next_e;
+    unsigned char e, next_e;
     unsigned int next_id;
-    int empty_below;
-    int f_below;
+    unsigned char floor_gens[NUM_FLOORS];
+    unsigned char floor_chips[NUM_FLOORS];
+    unsigned char below;
+    unsigned char mg, mc;
+    unsigned char src_g, src_c, dst_g, dst_c;
     
     // Reset visited bitset
     memset(visited, 0, BITSET_SIZE);
     
-    // Pad remaining pairs
+    // Pad remaining pairs; queued states are always kept canonical
     for (i = num_pairs; i < MAX_PAIRS; ++i) {
         initial->pairs[i] = 15;
     }
+    canonicalize(initial);
 
     mark_visited(get_state_id(initial));
     queue[tail++] = *initial;
@@ -141,57 +135,86 @@ int solve(State *initial, int num_pairs) {
         
         while (level_count--) {
             curr = queue[head++];
-            num_items = 0;
+            e = curr.elevator;
             
-            if (is_victory(&curr, num_pairs)) {
+            // Padding pairs sort last, so victory is "smallest pair is 15"
+            if (curr.pairs[0] == 15) {
                 cprintf("\r\n");
                 return dist;
             }
             
+            // Per-floor masks are built once per dequeued state; every
+            // candidate move only touches the current and target floors.
+            memset(floor_gens, 0, NUM_FLOORS);
+            memset(floor_chips, 0, NUM_FLOORS);
             for (p = 0; p < num_pairs; ++p) {
-                if ((curr.pairs[p] >> 2) == curr.elevator) items[num_items++] = p * 2;
-                if ((curr.pairs[p] & 3) == curr.elevator) items[num_items++] = p * 2 + 1;
+                floor_gens[curr.pairs[p] >> 2] |= (1 << p);
+                floor_chips[curr.pairs[p] & 3] |= (1 << p);
+            }
+            
+            num_items = 0;
+            for (p = 0; p < num_pairs; ++p) {
+                if (floor_gens[e] & (1 << p)) {
+                    items[num_items] = p * 2;
+                    item_mask[num_items++] = 1 << p;
+                }
+                if (floor_chips[e] & (1 << p)) {
+                    items[num_items] = p * 2 + 1;
+                    item_mask[num_items++] = 1 << p;
+                }
+            }
+            
+            // Never move down when every floor below is already empty
+            below = 0;
+            for (i = 0; i < e; ++i) {
+                below |= floor_gens[i] | floor_chips[i];
             }
             
             for (i = 0; i < num_items; ++i) {
                 for (j = i; j < num_items; ++j) {
+                    mg = 0;
+                    mc = 0;
+                    if (items[i] & 1) mc |= item_mask[i]; else mg |= item_mask[i];
+                    if (items[j] & 1) mc |= item_mask[j]; else mg |= item_mask[j];
+                    
+                    // The floor being left behind must stay safe
+                    src_g = floor_gens[e] & ~mg;
+                    src_c = floor_chips[e] & ~mc;
+                    if (!FLOOR_OK(src_g, src_c)) continue;
+                    
                     for (dir = 1; dir >= -1; dir -= 2) {
-                        next_e = (int)curr.elevator + dir;
-                        if (next_e < 0 || next_e >= NUM_FLOORS) continue;
-                        
-                        if (dir == -1) {
-                            empty_below = 1;
-                            for (f_below = 0; f_below < curr.elevator; ++f_below) {
-                                for (p = 0; p < num_pairs; ++p) {
-                                    if ((curr.pairs[p] >> 2) == f_below || (curr.pairs[p] & 3) == f_below) {
-                                        empty_below = 0; break;
-                                    }
-                                }
-                                if (!empty_below) break;
-                            }
-                            if (empty_below) continue;
+                        if (dir == 1) {
+                            if (e == NUM_FLOORS - 1) continue;
+                            next_e = e + 1;
+                        } else {
+                            if (e == 0 || !below) continue;
+                            next_e = e - 1;
                         }
                         
-                        next = curr;
-                        next.elevator = (unsigned char)next_e;
-                        if (items[i] % 2 == 0) next.pairs[items[i] / 2] = (next.pairs[items[i] / 2] & 3) | (next.elevator << 2);
-                        else next.pairs[items[i] / 2] = (next.pairs[items[i] / 2] & 0xFC) | next.elevator;
+                        dst_g = floor_gens[next_e] | mg;
+                        dst_c = floor_chips[next_e] | mc;
+                        if (!FLOOR_OK(dst_g, dst_c)) continue;
                         
+                        next = curr;
+                        next.elevator = next_e;
+                        p = items[i] >> 1;
+                        if (items[i] & 1) next.pairs[p] = (next.pairs[p] & 0xFC) | next_e;
+                        else next.pairs[p] = (next.pairs[p] & 3) | (next_e << 2);
                         if (j != i) {
-                            if (items[j] % 2 == 0) next.pairs[items[j] / 2] = (next.pairs[items[j] / 2] & 3) | (next.elevator << 2);
-                            else next.pairs[items[j] / 2] = (next.pairs[items[j] / 2] & 0xFC) | next.elevator;
+                            p = items[j] >> 1;
+                            if (items[j] & 1) next.pairs[p] = (next.pairs[p] & 0xFC) | next_e;
+                            else next.pairs[p] = (next.pairs[p] & 3) | (next_e << 2);
                         }
+                        resort(&next);
                         
-                        if (is_valid(&next)) {
-                            next_id = get_state_id(&next);
-                            if (!is_visited(next_id)) {
-                                if (tail >= QUEUE_SIZE) {
-                                    cprintf("\r\nQUEUE OVERFLOW!\r\n");
-                                    return -2;
-                                }
-                                mark_visited(next_id);
-                                queue[tail++] = next;
+                        next_id = get_state_id(&next);
+                        if (!is_visited(next_id)) {
+                            if (tail >= QUEUE_SIZE) {
+                                cprintf("\r\nQUEUE OVERFLOW!\r\n");
+                                return -2;
                             }
+                            mark_visited(next_id);
+                            queue[tail++] = next;
                         }
                     }
                 }
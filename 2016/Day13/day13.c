@@ -3,17 +3,14 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include "gridbfs.h"
+
 /* Constants */
 #define MAP_SIZE 64
-#define VISITED_SIZE (MAP_SIZE * MAP_SIZE / 8)
-#define QUEUE_SIZE (MAP_SIZE * MAP_SIZE)
-#define ERR_QUEUE_OVERFLOW -2
 
-/* Global buffers to stay off the stack */
-unsigned char visited[VISITED_SIZE];
-unsigned char qx[QUEUE_SIZE];
-unsigned char qy[QUEUE_SIZE];
-unsigned int qhead, qtail;
+/* Maze parameters for the gridbfs callbacks */
+unsigned int maze_favorite;
+unsigned char goal_x, goal_y;
 
 /* Function Prototypes */
 void run_tests(void);
@@ -23,8 +20,6 @@ int solve_part1(unsigned char start_x, unsigned char start_y,
 int solve_part2(unsigned char start_x, unsigned char start_y, 
                 unsigned char max_steps, unsigned int favorite_number);
 unsigned char is_wall(unsigned char x, unsigned char y, unsigned int favorite_number);
-void set_visited(unsigned char x, unsigned char y);
-unsigned char get_visited(unsigned char x, unsigned char y);
 
 int main(void) {
     int part1_res;
@@ -45,16 +40,16 @@ int main(void) {
     cprintf("\r\n--- FINAL ANSWERS ---\r\n");
     part1_res = solve_part1(1, 1, 31, 39, 1358);
 
-    if (part1_res == ERR_QUEUE_OVERFLOW) {
-        cprintf("PART 1: ERROR - Queue Overflow\r\n");
+    if (part1_res == GRIDBFS_ERR_IO) {
+        cprintf("PART 1: ERROR - Spill File I/O\r\n");
     } else {
         cprintf("PART 1: %d\r\n", part1_res);
     }
 
     /* Part 2: Start (1,1), Max 50 steps, Favorite 1358 */
     part2_res = solve_part2(1, 1, 50, 1358);
-    if (part2_res == ERR_QUEUE_OVERFLOW) {
-        cprintf("PART 2: ERROR - Queue Overflow\r\n");
+    if (part2_res == GRIDBFS_ERR_IO) {
+        cprintf("PART 2: ERROR - Spill File I/O\r\n");
     } else {
         cprintf("PART 2: %d\r\n", part2_res);
     }
@@ -84,131 +79,41 @@ unsigned char is_wall(unsigned char x, unsigned char y, unsigned int favorite_nu
     return bits % 2;
 }
 
-void set_visited(unsigned char x, unsigned char y) {
-    unsigned int pos = (unsigned int)y * MAP_SIZE + x;
-    visited[pos >> 3] |= (1 << (pos & 7));
+unsigned char is_open(unsigned char x, unsigned char y) {
+    return !is_wall(x, y, maze_favorite);
+}
+
+unsigned char stop_at_goal(unsigned char x, unsigned char y, unsigned int dist) {
+    (void)dist;
+    return x == goal_x && y == goal_y;
 }
 
-unsigned char get_visited(unsigned char x, unsigned char y) {
-    unsigned int pos = (unsigned int)y * MAP_SIZE + x;
-    return (visited[pos >> 3] & (1 << (pos & 7))) != 0;
+unsigned char visit_all(unsigned char x, unsigned char y, unsigned int dist) {
+    (void)x;
+    (void)y;
+    (void)dist;
+    return 0;
 }
 
 int solve_part1(unsigned char start_x, unsigned char start_y, 
                 unsigned char target_x, unsigned char target_y, 
                 unsigned int favorite_number) {
-    unsigned char x, y, nx, ny;
-    int dx[] = {0, 0, 1, -1};
-    int dy[] = {1, -1, 0, 0};
-    int i;
-    unsigned int steps = 0;
-    unsigned int current_level_size;
-    unsigned int next_level_size;
-
-    memset(visited, 0, sizeof(visited));
-    qhead = 0;
-    qtail = 0;
-
-    qx[qtail] = start_x;
-    qy[qtail] = start_y;
-    qtail = (qtail + 1) % QUEUE_SIZE;
-    set_visited(start_x, start_y);
-    current_level_size = 1;
-
-    while (qhead != qtail) {
-        next_level_size = 0;
-        while (current_level_size > 0) {
-            x = qx[qhead];
-            y = qy[qhead];
-            qhead = (qhead + 1) % QUEUE_SIZE;
-            current_level_size--;
-
-            if (x == target_x && y == target_y) return steps;
-
-            for (i = 0; i < 4; i++) {
-                nx = x + dx[i];
-                ny = y + dy[i];
-
-                /* Check bounds (x,y >= 0 is implicit since nx,ny are unsigned char) */
-                /* But we need to handle underflow from x-1 or y-1 */
-                if (dx[i] == -1 && x == 0) continue;
-                if (dy[i] == -1 && y == 0) continue;
-                if (nx >= MAP_SIZE || ny >= MAP_SIZE) continue;
-
-                if (!get_visited(nx, ny) && !is_wall(nx, ny, favorite_number)) {
-                    set_visited(nx, ny);
-                    qx[qtail] = nx;
-                    qy[qtail] = ny;
-                    qtail = (qtail + 1) % QUEUE_SIZE;
-                    next_level_size++;
-                    
-                    /* Queue overflow check */
-                    if (qtail == qhead) return ERR_QUEUE_OVERFLOW; 
-                }
-            }
-        }
-        steps++;
-        current_level_size = next_level_size;
-    }
-
-    return -1; /* Unreachable */
+    maze_favorite = favorite_number;
+    goal_x = target_x;
+    goal_y = target_y;
+    gridbfs_init(MAP_SIZE, MAP_SIZE, is_open);
+    return gridbfs_run(start_x, start_y, GRIDBFS_UNLIMITED, stop_at_goal);
 }
 
 int solve_part2(unsigned char start_x, unsigned char start_y, 
                 unsigned char max_steps, unsigned int favorite_number) {
-    unsigned char x, y, nx, ny;
-    int dx[] = {0, 0, 1, -1};
-    int dy[] = {1, -1, 0, 0};
-    int i;
-    unsigned int steps = 0;
-    unsigned int current_level_size;
-    unsigned int next_level_size;
-    unsigned int total_visited = 0;
-
-    memset(visited, 0, sizeof(visited));
-    qhead = 0;
-    qtail = 0;
-
-    qx[qtail] = start_x;
-    qy[qtail] = start_y;
-    qtail = (qtail + 1) % QUEUE_SIZE;
-    set_visited(start_x, start_y);
-    current_level_size = 1;
-    total_visited = 1;
-
-    while (qhead != qtail && steps < max_steps) {
-        next_level_size = 0;
-        while (current_level_size > 0) {
-            x = qx[qhead];
-            y = qy[qhead];
-            qhead = (qhead + 1) % QUEUE_SIZE;
-            current_level_size--;
-
-            for (i = 0; i < 4; i++) {
-                nx = x + dx[i];
-                ny = y + dy[i];
-
-                if (dx[i] == -1 && x == 0) continue;
-                if (dy[i] == -1 && y == 0) continue;
-                if (nx >= MAP_SIZE || ny >= MAP_SIZE) continue;
-
-                if (!get_visited(nx, ny) && !is_wall(nx, ny, favorite_number)) {
-                    set_visited(nx, ny);
-                    qx[qtail] = nx;
-                    qy[qtail] = ny;
-                    qtail = (qtail + 1) % QUEUE_SIZE;
-                    next_level_size++;
-                    total_visited++;
-                    
-                    if (qtail == qhead) return ERR_QUEUE_OVERFLOW;
-                }
-            }
-        }
-        steps++;
-        current_level_size = next_level_size;
-    }
+    int res;
 
-    return total_visited;
+    maze_favorite = favorite_number;
+    gridbfs_init(MAP_SIZE, MAP_SIZE, is_open);
+    res = gridbfs_run(start_x, start_y, max_steps, visit_all);
+    if (res == GRIDBFS_ERR_IO) return res;
+    return gridbfs_reached;
 }
 
 void run_tests(void) {
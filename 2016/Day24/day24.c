@@ -2,6 +2,8 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include "gridbfs.h"
+#include "heldkarp.h"
 
 /*
  * Advent of Code 2016 - Day 24: Air Duct Spelunking
@@ -9,28 +11,32 @@
  */
 
 #define MAX_POINTS 8
-#define MAX_QUEUE 256
 #define MAX_GRID_WIDTH 180
-#define MAX_GRID_HEIGHT 40
+#define MAX_GRID_HEIGHT 43
+#define ROW_BYTES ((MAX_GRID_WIDTH + 7) / 8)
 
 typedef struct {
-    signed char x, y;
+    unsigned char x, y;
 } Point;
 
-typedef struct {
-    signed char x, y;
-    int dist;
-} QueueItem;
-
-/* Global data to stay off the stack and fit in BSS */
-char grid[MAX_GRID_HEIGHT][MAX_GRID_WIDTH + 1];
+/* Global data to stay off the stack and fit in BSS.
+ * The maze is kept as two bitplanes (1 bit per cell): walls and numbered
+ * points. Visited marks are a third bitplane inside gridbfs. */
+unsigned char walls[MAX_GRID_HEIGHT][ROW_BYTES];
+unsigned char marks[MAX_GRID_HEIGHT][ROW_BYTES];
+char line_buf[MAX_GRID_WIDTH + 2];
 Point points[MAX_POINTS];
 int distances[MAX_POINTS][MAX_POINTS];
-unsigned char visited[MAX_GRID_HEIGHT][MAX_GRID_WIDTH];
-QueueItem queue[MAX_QUEUE];
 int num_points;
 int grid_w, grid_h;
 
+/* Source point and number of points still to reach in the current BFS */
+int bfs_source;
+int bfs_pending;
+
+/* Single-bit masks, avoiding variable shifts on the 6502 */
+const unsigned char bit_mask[8] = {1, 2, 4, 8, 16, 32, 64, 128};
+
 /* TSP results */
 int min_dist_p1;
 int min_dist_p2;
@@ -46,154 +52,165 @@ const char* example_grid[] = {
 #define EXAMPLE_W 11
 #define EXAMPLE_H 5
 
-/* BFS to find shortest distance between two numbered points */
-int get_distance(int p1_idx, int p2_idx) {
-    int head = 0, tail = 0;
-    signed char dx[] = {0, 0, 1, -1};
-    signed char dy[] = {1, -1, 0, 0};
-    int i;
-    Point start;
-    Point end;
-    
-    start = points[p1_idx];
-    end = points[p2_idx];
-    
-    /* Clear visited array for current grid dimensions */
-    for (i = 0; i < grid_h; i++) {
-        memset(visited[i], 0, grid_w);
-    }
-    
-    /* Initialize queue */
-    queue[tail].x = start.x;
-    queue[tail].y = start.y;
-    queue[tail].dist = 0;
-    tail++;
-    
-    visited[start.y][start.x] = 1;
-    
-    while (head != tail) {
-        QueueItem current;
-        current = queue[head];
-        head = (head + 1) % MAX_QUEUE;
-        
-        if (current.x == end.x && current.y == end.y) {
-            return current.dist;
-        }
-        
-        for (i = 0; i < 4; i++) {
-            signed char nx = current.x + dx[i];
-            signed char ny = current.y + dy[i];
-            
-            /* Bounds and wall check */
-            if (nx >= 0 && nx < grid_w && ny >= 0 && ny < grid_h &&
-                grid[ny][nx] != '#' && !visited[ny][nx]) {
-                
-                visited[ny][nx] = 1;
-                queue[tail].x = nx;
-                queue[tail].y = ny;
-                queue[tail].dist = current.dist + 1;
-                tail = (tail + 1) % MAX_QUEUE;
-                
-                /* Check for queue overflow */
-                if (tail == head) {
-                    return -2; /* Overflow indicator */
-                }
-            }
+unsigned char is_open(unsigned char x, unsigned char y) {
+    return !(walls[y][x >> 3] & bit_mask[x & 7]);
+}
+
+/* Record the distance to every numbered point this BFS reaches; stop
+ * once all higher-numbered points have been seen. */
+unsigned char record_point(unsigned char x, unsigned char y, unsigned int dist) {
+    int k;
+    if (!(marks[y][x >> 3] & bit_mask[x & 7])) return 0;
+    for (k = bfs_source + 1; k < num_points; k++) {
+        if (points[k].x == x && points[k].y == y) {
+            distances[bfs_source][k] = dist;
+            distances[k][bfs_source] = dist;
+            return --bfs_pending == 0;
         }
     }
-    
-    return -1; /* No path found */
+    return 0;
 }
 
-/* Helper to swap integers in array */
-void swap_indices(int *a, int *b) {
-    int temp = *a;
-    *a = *b;
-    *b = temp;
+/* Pack one text row of the maze into the bitplanes */
+void pack_row(int y, const char *row) {
+    int x;
+    memset(walls[y], 0, ROW_BYTES);
+    memset(marks[y], 0, ROW_BYTES);
+    for (x = 0; x < grid_w && row[x]; x++) {
+        if (row[x] == '#') {
+            walls[y][x >> 3] |= bit_mask[x & 7];
+        } else if (row[x] >= '0' && row[x] < '0' + MAX_POINTS) {
+            int val = row[x] - '0';
+            marks[y][x >> 3] |= bit_mask[x & 7];
+            points[val].x = x;
+            points[val].y = y;
+            if (val >= num_points) num_points = val + 1;
+        }
+    }
 }
 
-/* Recursive TSP solver using permutations */
-void solve_tsp_recursive(int *a, int l, int r, int return_to_zero) {
-    int i;
-    int total;
-    if (l == r) {
-        /* Path starts at '0' then follows permutation in 'a' */
-        total = distances[0][a[0]];
-        for (i = 0; i < r; i++) {
-            total += distances[a[i]][a[i+1]];
+/* Fill the distance matrix with one BFS per point. Each flood records all
+ * higher-numbered points as it reaches them, so N points take N-1 floods
+ * instead of one per pair. Returns 0 or the failing BFS result. */
+int compute_distances(void) {
+    int i, j, res;
+
+    for (i = 0; i < num_points; i++) {
+        for (j = 0; j < num_points; j++) {
+            distances[i][j] = (i == j) ? 0 : -1;
         }
-        
-        if (return_to_zero) {
-            /* Return to starting point '0' */
-            total += distances[a[r]][0];
-            if (total < min_dist_p2) min_dist_p2 = total;
-        } else {
-            /* End at the last visited point */
-            if (total < min_dist_p1) min_dist_p1 = total;
+    }
+
+    if (!gridbfs_init(grid_w, grid_h, is_open)) {
+        cprintf("GRID %dX%d TOO LARGE FOR BFS\r\n", grid_w, grid_h);
+        return GRIDBFS_ERR_SIZE;
+    }
+    for (i = 0; i < num_points - 1; i++) {
+        bfs_source = i;
+        bfs_pending = num_points - 1 - i;
+        res = gridbfs_run(points[i].x, points[i].y, GRIDBFS_UNLIMITED,
+                          record_point);
+        if (res < 0) {
+            cprintf("BFS FROM %d FAILED (%d)\r\n", i, res);
+            return res;
         }
-    } else {
-        for (i = l; i <= r; i++) {
-            swap_indices((a + l), (a + i));
-            solve_tsp_recursive(a, l + 1, r, return_to_zero);
-            swap_indices((a + l), (a + i));
+    }
+    return 0;
+}
+
+/* Fill the distance matrix and run both TSP variants.
+ * Returns 0 on success or the failing BFS result. */
+int solve_grid(void) {
+    int i, j;
+    
+    cprintf("FOUND %d POINTS.\r\n", num_points);
+    cprintf("CALCULATING BFS DISTANCES...\r\n");
+    i = compute_distances();
+    if (i != 0) return i;
+    
+    for (i = 0; i < num_points; i++) {
+        for (j = 0; j < num_points; j++) {
+            hk_weight[i][j] = distances[i][j];
         }
     }
+    
+    cprintf("SOLVING TSP (HELD-KARP)...\r\n");
+    
+    /* Part 1: Visit all points once, starting at '0' */
+    min_dist_p1 = hk_solve(num_points, 0, HK_MINIMIZE, HK_PATH);
+    
+    /* Part 2: Visit all points and return to 0 */
+    min_dist_p2 = hk_solve(num_points, 0, HK_MINIMIZE, HK_CYCLE);
+    return 0;
 }
 
 /* Run the example case */
 void run_example(void) {
-    int i, j;
-    int p_indices[MAX_POINTS];
+    int i;
     
     cprintf("TEST: EXAMPLE GRID (%dx%d)\r\n", EXAMPLE_W, EXAMPLE_H);
     grid_w = EXAMPLE_W;
     grid_h = EXAMPLE_H;
-    num_points = 0;
     
-    /* Load example into grid buffer and identify points */
+    /* Pack example into the bitplanes */
+    num_points = 0;
     for (i = 0; i < grid_h; i++) {
-        strcpy(grid[i], example_grid[i]);
-        for (j = 0; j < grid_w; j++) {
-            if (grid[i][j] >= '0' && grid[i][j] <= '9') {
-                int val = grid[i][j] - '0';
-                points[val].x = j;
-                points[val].y = i;
-                if (val >= num_points) num_points = val + 1;
-            }
-        }
-    }
-    
-    cprintf("FOUND %d POINTS.\r\n", num_points);
-    cprintf("CALCULATING BFS DISTANCES...\r\n");
-    for (i = 0; i < num_points; i++) {
-        for (j = i + 1; j < num_points; j++) {
-            int d = get_distance(i, j);
-            distances[i][j] = d;
-            distances[j][i] = d;
-        }
-    }
-    
-    /* Initialize permutation indices (excluding starting point 0) */
-    for (i = 0; i < num_points - 1; i++) {
-        p_indices[i] = i + 1;
+        pack_row(i, example_grid[i]);
     }
     
-    min_dist_p1 = 32767;
-    min_dist_p2 = 32767;
-    
-    cprintf("SOLVING TSP PERMUTATIONS...\r\n");
+    if (solve_grid() != 0) return;
     
-    /* Part 1: Visit all points once */
-    solve_tsp_recursive(p_indices, 0, num_points - 2, 0);
     cprintf("PART 1 RESULT: %d ", min_dist_p1);
     if (min_dist_p1 == 14) cprintf("[PASS]\r\n"); else cprintf("[FAIL]\r\n");
     
-    /* Part 2: Visit all points and return to 0 */
-    solve_tsp_recursive(p_indices, 0, num_points - 2, 1);
     cprintf("PART 2 RESULT: %d ", min_dist_p2);
     if (min_dist_p2 == 20) cprintf("[PASS]\r\n"); else cprintf("[FAIL]\r\n");
 }
 
+/* Try to load the puzzle grid from a file */
+int load_file(const char *filename) {
+    FILE *fp;
+    int len;
+
+    fp = fopen(filename, "r");
+    if (!fp) {
+        return 0;
+    }
+
+    grid_w = 0;
+    grid_h = 0;
+    num_points = 0;
+    while (grid_h < MAX_GRID_HEIGHT &&
+           fgets(line_buf, sizeof(line_buf), fp)) {
+        len = strlen(line_buf);
+        while (len > 0 && (line_buf[len - 1] == '\r' ||
+                           line_buf[len - 1] == '\n')) {
+            line_buf[--len] = 0;
+        }
+        if (len == 0) continue;
+        if (grid_w == 0) grid_w = len > MAX_GRID_WIDTH ? MAX_GRID_WIDTH : len;
+        pack_row(grid_h, line_buf);
+        grid_h++;
+    }
+
+    fclose(fp);
+    return grid_h > 0;
+}
+
+/* Solve the real puzzle from input.txt when it is on the disk */
+void run_input(void) {
+    if (!load_file("input.txt")) {
+        cprintf("NO INPUT.TXT, SKIPPING PUZZLE.\r\n");
+        return;
+    }
+    cprintf("PUZZLE INPUT (%dx%d)\r\n", grid_w, grid_h);
+    
+    if (solve_grid() != 0) return;
+    
+    cprintf("PART 1: %d\r\n", min_dist_p1);
+    cprintf("PART 2: %d\r\n", min_dist_p2);
+}
+
 int main(void) {
     /* Set up C64 screen colors */
     bgcolor(COLOR_BLACK);
@@ -206,6 +223,8 @@ int main(void) {
     cprintf("============================\r\n\r\n");
     
     run_example();
+    cprintf("\r\n");
+    run_input();
     
     cprintf("\r\nDONE.\r\n");
     cprintf("PRESS ENTER TO EXIT.\r\n");
@@ -2,12 +2,41 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include "vicscreen.h"
 
 #define GRID_WIDTH 50
 #define GRID_HEIGHT 6
 
+/* Each row is a 50-bit mask in 7 bytes: bit j of byte k is pixel 8k + j */
+#define ROW_BYTES ((GRID_WIDTH + 7) / 8)
+#define LAST_MASK ((1 << (GRID_WIDTH & 7)) - 1)
+
 /* Global grid to avoid stack issues */
-char grid[GRID_HEIGHT][GRID_WIDTH];
+unsigned char grid[GRID_HEIGHT][ROW_BYTES];
+
+/* Number of set bits in each byte value */
+unsigned char bit_count[256];
+
+/* Command kinds for the streaming parser */
+#define CMD_NONE 0
+#define CMD_RECT 1
+#define CMD_ROW 2
+#define CMD_COL 3
+
+/* Streaming parser state: a command is built up as its characters arrive,
+ * so lines never need to be buffered or copied */
+typedef struct {
+  unsigned char kind;
+  unsigned char col;    /* position in the current line (stops at 255) */
+  unsigned char field;  /* numbers completed so far on this line */
+  unsigned char digits; /* 1 while inside a number */
+  unsigned int value;   /* number being read */
+  unsigned int a, b;    /* the two numbers of the command */
+} CommandParser;
+
+/* Input is read from disk in blocks of this size */
+#define BLOCK_SIZE 256
+char read_block[BLOCK_SIZE];
 
 /* Function Prototypes */
 void init_grid(void);
@@ -15,9 +44,14 @@ void rect(int a, int b);
 void rotate_row(int row, int by);
 void rotate_col(int col, int by);
 int count_pixels(void);
-void display_grid(void);
+unsigned char reserve_display(void);
+void draw_grid(unsigned char row);
 void run_tests(void);
+void solve_input_file(const char *filename);
 
+void parser_reset(CommandParser *p);
+unsigned char parser_put(CommandParser *p, char c);
+void apply_command(const CommandParser *p);
 void process_command(const char *cmd);
 
 int main(void) {
@@ -34,6 +68,8 @@ int main(void) {
   init_grid();
   run_tests();
 
+  solve_input_file("input.txt");
+
   cprintf("\r\nPRESS ENTER TO EXIT.\r\n");
   cgetc();
 
@@ -41,109 +77,206 @@ int main(void) {
 }
 
 void init_grid(void) {
-  memset(grid, '.', sizeof(grid));
+  int i;
+
+  memset(grid, 0, sizeof(grid));
+  for (i = 1; i < 256; i++) {
+    bit_count[i] = (unsigned char)((i & 1) + bit_count[i >> 1]);
+  }
 }
 
 void rect(int a, int b) {
-  int y, x;
-  for (y = 0; y < b && y < GRID_HEIGHT; y++) {
-    for (x = 0; x < a && x < GRID_WIDTH; x++) {
-      grid[y][x] = '#';
+  int y;
+  unsigned char full, part;
+
+  if (a > GRID_WIDTH) a = GRID_WIDTH;
+  if (b > GRID_HEIGHT) b = GRID_HEIGHT;
+  if (a <= 0) return;
+  full = (unsigned char)(a >> 3);
+  part = (unsigned char)((1 << (a & 7)) - 1);
+
+  for (y = 0; y < b; y++) {
+    memset(grid[y], 0xFF, full);
+    if (part) {
+      grid[y][full] |= part;
+    }
+  }
+}
+
+/* out = in shifted towards higher pixels by n bits (n < GRID_WIDTH) */
+static void shift_up(unsigned char *out, const unsigned char *in,
+                     unsigned char n) {
+  unsigned char q = n >> 3;
+  unsigned char s = n & 7;
+  signed char k;
+
+  for (k = ROW_BYTES - 1; k >= 0; k--) {
+    if (k < q) {
+      out[k] = 0;
+    } else {
+      out[k] = (unsigned char)(in[k - q] << s);
+      if (s && k > q) {
+        out[k] |= in[k - q - 1] >> (8 - s);
+      }
+    }
+  }
+}
+
+/* out = in shifted towards lower pixels by n bits (n < GRID_WIDTH) */
+static void shift_down(unsigned char *out, const unsigned char *in,
+                       unsigned char n) {
+  unsigned char q = n >> 3;
+  unsigned char s = n & 7;
+  unsigned char k;
+
+  for (k = 0; k < ROW_BYTES; k++) {
+    if (k + q >= ROW_BYTES) {
+      out[k] = 0;
+    } else {
+      out[k] = in[k + q] >> s;
+      if (s && k + q + 1 < ROW_BYTES) {
+        out[k] |= (unsigned char)(in[k + q + 1] << (8 - s));
+      }
     }
   }
 }
 
+/* Rotate right by 'by': (row << by) | (row >> (50 - by)), cut to 50 bits */
 void rotate_row(int row, int by) {
-  char temp[GRID_WIDTH];
-  int x;
+  unsigned char up[ROW_BYTES];
+  unsigned char down[ROW_BYTES];
+  unsigned char k;
+
   if (row < 0 || row >= GRID_HEIGHT) return;
   by %= GRID_WIDTH;
   if (by == 0) return;
 
-  memcpy(temp, grid[row], GRID_WIDTH);
-  for (x = 0; x < GRID_WIDTH; x++) {
-    grid[row][(x + by) % GRID_WIDTH] = temp[x];
+  shift_up(up, grid[row], (unsigned char)by);
+  shift_down(down, grid[row], (unsigned char)(GRID_WIDTH - by));
+  for (k = 0; k < ROW_BYTES; k++) {
+    grid[row][k] = up[k] | down[k];
   }
+  grid[row][ROW_BYTES - 1] &= LAST_MASK;
 }
 
+/* Gather the column into 6 bits (bit y = row y), rotate and scatter back */
 void rotate_col(int col, int by) {
-  char temp[GRID_HEIGHT];
-  int y;
+  unsigned char byte, bit, y, v;
+
   if (col < 0 || col >= GRID_WIDTH) return;
   by %= GRID_HEIGHT;
   if (by == 0) return;
 
+  byte = (unsigned char)(col >> 3);
+  bit = (unsigned char)(1 << (col & 7));
+  v = 0;
   for (y = 0; y < GRID_HEIGHT; y++) {
-    temp[y] = grid[y][col];
+    if (grid[y][byte] & bit) v |= 1 << y;
   }
+  v = (unsigned char)((v << by) | (v >> (GRID_HEIGHT - by)));
   for (y = 0; y < GRID_HEIGHT; y++) {
-    grid[(y + by) % GRID_HEIGHT][col] = temp[y];
+    if (v & (1 << y)) {
+      grid[y][byte] |= bit;
+    } else {
+      grid[y][byte] &= (unsigned char)~bit;
+    }
   }
 }
 
-void process_command(const char *cmd) {
-  int a, b;
-  char *p;
-  const char rect_prefix[] = "rect ";
-  const char row_prefix[] = "rotate row y=";
-  const char col_prefix[] = "rotate column x=";
-  const char by_msg[] = " by ";
-
-  if (strncmp(cmd, rect_prefix, sizeof(rect_prefix) - 1) == 0) {
-    a = atoi(cmd + sizeof(rect_prefix) - 1);
-    p = strchr(cmd + sizeof(rect_prefix) - 1, 'x');
-    if (p) {
-      b = atoi(p + 1);
-      rect(a, b);
+void parser_reset(CommandParser *p) {
+  p->kind = CMD_NONE;
+  p->col = 0;
+  p->field = 0;
+  p->digits = 0;
+}
+
+/* Feed one character; 1 when it completes a command.
+ * "rect", "rotate row" and "rotate column" differ at columns 1 and 7, and
+ * the two numbers are the only digits on a line. */
+unsigned char parser_put(CommandParser *p, char c) {
+  unsigned char done;
+
+  if (c >= '0' && c <= '9') {
+    p->value = p->digits ? p->value * 10 + (c - '0') : (unsigned int)(c - '0');
+    p->digits = 1;
+  } else {
+    if (p->digits) {
+      if (p->field == 0) {
+        p->a = p->value;
+      } else {
+        p->b = p->value;
+      }
+      p->field++;
+      p->digits = 0;
     }
-  } else if (strncmp(cmd, row_prefix, sizeof(row_prefix) - 1) == 0) {
-    a = atoi(cmd + sizeof(row_prefix) - 1);
-    p = strstr(cmd + sizeof(row_prefix) - 1, by_msg);
-    if (p) {
-      b = atoi(p + sizeof(by_msg) - 1);
-      rotate_row(a, b);
+    if (c == '\n' || c == '\r') {
+      /* Keep kind, a and b for the caller; column 1 sets the next kind */
+      done = p->kind != CMD_NONE && p->field == 2 && p->col > 1;
+      p->col = 0;
+      p->field = 0;
+      return done;
     }
-  } else if (strncmp(cmd, col_prefix, sizeof(col_prefix) - 1) == 0) {
-    a = atoi(cmd + sizeof(col_prefix) - 1);
-    p = strstr(cmd + sizeof(col_prefix) - 1, by_msg);
-    if (p) {
-      b = atoi(p + sizeof(by_msg) - 1);
-      rotate_col(a, b);
+    if (p->col == 1) {
+      p->kind = (c == 'e') ? CMD_RECT : (c == 'o') ? CMD_ROW : CMD_NONE;
+    } else if (p->col == 7 && p->kind == CMD_ROW && c == 'c') {
+      p->kind = CMD_COL;
     }
   }
+  if (p->col < 255) {
+    p->col++;
+  }
+  return 0;
 }
 
-int count_pixels(void) {
-  int y, x, count = 0;
-  for (y = 0; y < GRID_HEIGHT; y++) {
-    for (x = 0; x < GRID_WIDTH; x++) {
-      if (grid[y][x] == '#') count++;
-    }
+void apply_command(const CommandParser *p) {
+  switch (p->kind) {
+    case CMD_RECT: rect(p->a, p->b); break;
+    case CMD_ROW: rotate_row(p->a, p->b); break;
+    case CMD_COL: rotate_col(p->a, p->b); break;
   }
-  return count;
 }
 
-void display_grid(void) {
-  int y, x;
-  cprintf("\r\nLEFT HALF (Cols 0-%d):\r\n", (GRID_WIDTH / 2) - 1);
-  for (y = 0; y < GRID_HEIGHT; y++) {
-    for (x = 0; x < GRID_WIDTH / 2; x++) {
-      cputc(grid[y][x] == '#' ? '#' : '.');
-    }
-    cprintf("\r\n");
+/* Run a single in-memory command line */
+void process_command(const char *cmd) {
+  CommandParser p;
+
+  parser_reset(&p);
+  while (*cmd) {
+    parser_put(&p, *cmd++);
+  }
+  if (parser_put(&p, '\n')) {
+    apply_command(&p);
   }
-  cprintf("\r\nRIGHT HALF (Cols %d-%d):\r\n", GRID_WIDTH / 2, GRID_WIDTH - 1);
+}
+
+int count_pixels(void) {
+  int count = 0;
+  unsigned char y, k;
   for (y = 0; y < GRID_HEIGHT; y++) {
-    for (x = GRID_WIDTH / 2; x < GRID_WIDTH; x++) {
-      cputc(grid[y][x] == '#' ? '#' : '.');
+    for (k = 0; k < ROW_BYTES; k++) {
+      count += bit_count[grid[y][k]];
     }
-    cprintf("\r\n");
   }
+  return count;
+}
+
+/* Leave three blank text lines for the display; returns the first one */
+unsigned char reserve_display(void) {
+  cprintf("\r\nSCREEN:\r\n\r\n\r\n\r\n");
+  return wherey() - 3;
+}
+
+/* Write the grid straight into screen RAM, 2x2 pixels per character, so
+ * it fits on 25x3 characters and can be redrawn after every command */
+void draw_grid(unsigned char row) {
+  vs_text_blocks(0, row, grid[0], ROW_BYTES, GRID_WIDTH, GRID_HEIGHT,
+                 COLOR_WHITE);
 }
 
 void run_tests(void) {
   int i;
   int res;
+  unsigned char screen_row;
   const char *test_cmds[] = {
     "rect 3x2",
     "rotate column x=1 by 1",
@@ -156,9 +289,11 @@ void run_tests(void) {
   int num_cmds = sizeof(test_cmds) / sizeof(test_cmds[0]);
 
   cprintf("\r\nRUNNING TESTS...\r\n");
+  screen_row = reserve_display();
 
   for (i = 0; i < num_cmds; i++) {
     process_command(test_cmds[i]);
+    draw_grid(screen_row);
   }
 
   res = count_pixels();
@@ -168,6 +303,47 @@ void run_tests(void) {
   } else {
     cprintf("FAIL (got %d, expected 10)\r\n", res);
   }
+}
+
+/* Run the puzzle input from disk. The file is read a block at a time and
+ * each command is applied, and the screen redrawn, as soon as it is parsed. */
+void solve_input_file(const char *filename) {
+  FILE *fp;
+  CommandParser parser;
+  size_t len, i;
+  unsigned int count = 0;
+  unsigned char screen_row;
+
+  fp = fopen(filename, "r");
+  if (!fp) {
+    cprintf("\r\n%s NOT FOUND.\r\n", filename);
+    return;
+  }
+
+  cprintf("\r\nINPUT: %s\r\n", filename);
+  memset(grid, 0, sizeof(grid));
+  screen_row = reserve_display();
+  parser_reset(&parser);
+
+  while ((len = fread(read_block, 1, BLOCK_SIZE, fp)) > 0) {
+    for (i = 0; i < len; i++) {
+      if (parser_put(&parser, read_block[i])) {
+        apply_command(&parser);
+        draw_grid(screen_row);
+        count++;
+      }
+    }
+  }
+  fclose(fp);
+
+  /* The last line may have no newline of its own */
+  if (parser_put(&parser, '\n')) {
+    apply_command(&parser);
+    draw_grid(screen_row);
+    count++;
+  }
 
-  display_grid();
+  cprintf("%u COMMANDS\r\n", count);
+  cprintf("PART 1: %d PIXELS LIT\r\n", count_pixels());
+  cprintf("PART 2: READ THE SCREEN ABOVE\r\n");
 }
@@ -0,0 +1,205 @@
+/* gridbfs.c - Shared level-synchronous grid BFS with disk-backed frontier */
+
+#include <stdio.h>
+#include <string.h>
+#include "gridbfs.h"
+
+typedef struct {
+    unsigned char x, y;
+} Cell;
+
+/* Frontier buffers, swapped between current and next level */
+static Cell buf_a[GRIDBFS_RAM_ENTRIES];
+static Cell buf_b[GRIDBFS_RAM_ENTRIES];
+
+static unsigned char visited[GRIDBFS_MAX_CELLS / 8];
+static unsigned int row_base[256];
+static unsigned char grid_w, grid_h;
+static gridbfs_open_fn open_cell;
+
+static const char spill_a[] = GRIDBFS_SPILL_A;
+static const char spill_b[] = GRIDBFS_SPILL_B;
+
+/* Next level under construction */
+static Cell *next_buf;
+static unsigned int next_count;
+static FILE *next_file;
+static const char *next_name;
+static unsigned int next_file_count;
+static unsigned char io_error;
+
+unsigned int gridbfs_reached;
+unsigned int gridbfs_spilled;
+
+unsigned char gridbfs_init(unsigned char width, unsigned char height,
+                           gridbfs_open_fn is_open) {
+    unsigned int base = 0;
+    unsigned char y;
+
+    /* The visited bitset is static, so larger grids cannot be searched */
+    if (!width || !height ||
+        (unsigned int)width * height > GRIDBFS_MAX_CELLS) {
+        grid_w = 0;
+        grid_h = 0;
+        return 0;
+    }
+
+    grid_w = width;
+    grid_h = height;
+    open_cell = is_open;
+
+    /* Row offsets avoid a 16-bit multiply per visited lookup */
+    for (y = 0; y < height; ++y) {
+        row_base[y] = base;
+        base += width;
+    }
+    return 1;
+}
+
+/* Flush the full next-level buffer to its spill file */
+static void spill_next(void) {
+    if (!next_file) {
+        remove(next_name);
+        next_file = fopen(next_name, "w");
+        if (!next_file) {
+            io_error = 1;
+            return;
+        }
+    }
+    if (fwrite(next_buf, sizeof(Cell), GRIDBFS_RAM_ENTRIES, next_file) !=
+        GRIDBFS_RAM_ENTRIES) {
+        io_error = 1;
+        return;
+    }
+    next_file_count += GRIDBFS_RAM_ENTRIES;
+    gridbfs_spilled += GRIDBFS_RAM_ENTRIES;
+    next_count = 0;
+}
+
+static void close_spill(FILE **fp, const char *name) {
+    if (*fp) {
+        fclose(*fp);
+        *fp = NULL;
+        remove(name);
+    }
+}
+
+int gridbfs_run(unsigned char sx, unsigned char sy, unsigned int max_depth,
+                gridbfs_visit_fn on_visit) {
+    Cell *cur_buf;
+    unsigned int cur_count;
+    FILE *cur_file = NULL;
+    const char *cur_name = spill_b;
+    unsigned int cur_file_count;
+    unsigned int dist = 0;
+    unsigned int i, pos;
+    unsigned char d, x, y, nx, ny;
+    int result = GRIDBFS_NOT_FOUND;
+
+    if (sx >= grid_w || sy >= grid_h) return GRIDBFS_ERR_SIZE;
+    memset(visited, 0, (row_base[grid_h - 1] + grid_w + 7) >> 3);
+    gridbfs_reached = 1;
+    gridbfs_spilled = 0;
+    io_error = 0;
+
+    next_buf = buf_a;
+    next_count = 0;
+    next_file = NULL;
+    next_name = spill_a;
+    next_file_count = 0;
+
+    pos = row_base[sy] + sx;
+    visited[pos >> 3] |= (1 << (pos & 7));
+    if (on_visit(sx, sy, 0)) return 0;
+    next_buf[next_count].x = sx;
+    next_buf[next_count].y = sy;
+    ++next_count;
+
+    while ((next_count || next_file_count) && dist < max_depth) {
+        /* The finished next level becomes the level to expand */
+        cur_buf = next_buf;
+        cur_count = next_count;
+        cur_name = next_name;
+        cur_file_count = next_file_count;
+        if (next_file) {
+            fclose(next_file);
+            next_file = NULL;
+            cur_file = fopen(cur_name, "r");
+            if (!cur_file) {
+                remove(cur_name);
+                return GRIDBFS_ERR_IO;
+            }
+        }
+
+        next_buf = (cur_buf == buf_a) ? buf_b : buf_a;
+        next_count = 0;
+        next_name = (cur_name == spill_a) ? spill_b : spill_a;
+        next_file_count = 0;
+        ++dist;
+
+        for (;;) {
+            for (i = 0; i < cur_count; ++i) {
+                x = cur_buf[i].x;
+                y = cur_buf[i].y;
+                for (d = 0; d < 4; ++d) {
+                    nx = x;
+                    ny = y;
+                    switch (d) {
+                    case 0:
+                        if (++ny >= grid_h) continue;
+                        break;
+                    case 1:
+                        if (ny-- == 0) continue;
+                        break;
+                    case 2:
+                        if (++nx >= grid_w) continue;
+                        break;
+                    default:
+                        if (nx-- == 0) continue;
+                        break;
+                    }
+
+                    pos = row_base[ny] + nx;
+                    if (visited[pos >> 3] & (1 << (pos & 7))) continue;
+                    if (!open_cell(nx, ny)) continue;
+                    visited[pos >> 3] |= (1 << (pos & 7));
+                    ++gridbfs_reached;
+
+                    if (on_visit(nx, ny, dist)) {
+                        result = (int)dist;
+                        goto done;
+                    }
+
+                    if (next_count == GRIDBFS_RAM_ENTRIES) {
+                        spill_next();
+                        if (io_error) {
+                            result = GRIDBFS_ERR_IO;
+                            goto done;
+                        }
+                    }
+                    next_buf[next_count].x = nx;
+                    next_buf[next_count].y = ny;
+                    ++next_count;
+                }
+            }
+
+            /* Stream the spilled part of this level back in */
+            if (!cur_file_count) break;
+            cur_count = cur_file_count < GRIDBFS_RAM_ENTRIES
+                            ? cur_file_count
+                            : GRIDBFS_RAM_ENTRIES;
+            if (fread(cur_buf, sizeof(Cell), cur_count, cur_file) !=
+                cur_count) {
+                result = GRIDBFS_ERR_IO;
+                goto done;
+            }
+            cur_file_count -= cur_count;
+        }
+        close_spill(&cur_file, cur_name);
+    }
+
+done:
+    close_spill(&cur_file, cur_name);
+    close_spill(&next_file, next_name);
+    return result;
+}
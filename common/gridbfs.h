@@ -0,0 +1,56 @@
+/* gridbfs.h - Shared level-synchronous grid BFS for maze puzzles
+ *
+ * The frontier lives in two small RAM buffers (current and next level).
+ * When the next level outgrows its buffer, full buffers are flushed to a
+ * sequential file and streamed back in when that level is expanded, so
+ * the search never fails with a queue overflow on large mazes.
+ */
+
+#ifndef GRIDBFS_H
+#define GRIDBFS_H
+
+/* Frontier entries kept in RAM per level (2 bytes each, two buffers) */
+#ifndef GRIDBFS_RAM_ENTRIES
+#define GRIDBFS_RAM_ENTRIES 512
+#endif
+
+/* Largest grid (width * height) the visited bitset can cover */
+#ifndef GRIDBFS_MAX_CELLS
+#define GRIDBFS_MAX_CELLS 8192
+#endif
+
+/* Spill files for alternating BFS levels */
+#define GRIDBFS_SPILL_A "bfsq.a"
+#define GRIDBFS_SPILL_B "bfsq.b"
+
+#define GRIDBFS_UNLIMITED 0xFFFF
+#define GRIDBFS_NOT_FOUND -1
+#define GRIDBFS_ERR_SIZE -2
+#define GRIDBFS_ERR_IO -3
+
+/* Returns nonzero if (x, y) can be entered */
+typedef unsigned char (*gridbfs_open_fn)(unsigned char x, unsigned char y);
+
+/* Called once per cell when it is first reached, in BFS order.
+ * Return nonzero to stop the search at this cell. */
+typedef unsigned char (*gridbfs_visit_fn)(unsigned char x, unsigned char y,
+                                          unsigned int dist);
+
+/* Set grid dimensions and the passability test used by gridbfs_run.
+ * Returns 0, and leaves gridbfs_run failing with GRIDBFS_ERR_SIZE, if the
+ * grid is empty or has more than GRIDBFS_MAX_CELLS cells. */
+unsigned char gridbfs_init(unsigned char width, unsigned char height,
+                           gridbfs_open_fn is_open);
+
+/* Flood from (sx, sy) up to max_depth steps. Returns the distance of the
+ * cell where on_visit asked to stop, GRIDBFS_NOT_FOUND if the reachable
+ * area was exhausted, GRIDBFS_ERR_SIZE if the grid was rejected or the
+ * start is outside it, or GRIDBFS_ERR_IO if the spill file failed. */
+int gridbfs_run(unsigned char sx, unsigned char sy, unsigned int max_depth,
+                gridbfs_visit_fn on_visit);
+
+/* Statistics for the last gridbfs_run */
+extern unsigned int gridbfs_reached; /* cells reached, including start */
+extern unsigned int gridbfs_spilled; /* frontier entries written to disk */
+
+#endif /* GRIDBFS_H */
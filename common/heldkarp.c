@@ -0,0 +1,107 @@
+/* heldkarp.c - Shared Held-Karp bitmask DP for small TSP-style puzzles */
+
+#include "heldkarp.h"
+
+int hk_weight[HK_MAX_NODES][HK_MAX_NODES];
+
+/* best[mask][last]: best total of a route covering mask, ending at last */
+static int best[1 << HK_MAX_NODES][HK_MAX_NODES];
+
+/* Parameters and result of the last solve, for hk_path */
+static unsigned char last_n;
+static unsigned char last_start;
+static unsigned char last_objective;
+static unsigned char last_end;
+static int last_total;
+
+/* Nonzero if candidate a beats incumbent b under the objective */
+static unsigned char better(int a, int b) {
+    if (b == HK_NONE) return 1;
+    return last_objective == HK_MAXIMIZE ? a > b : a < b;
+}
+
+int hk_solve(unsigned char n, unsigned char start, unsigned char objective,
+             unsigned char shape) {
+    unsigned int full = (1u << n) - 1;
+    unsigned int mask, bit;
+    unsigned char last, next;
+    int *row;
+    int cur, w, cand;
+
+    if (shape == HK_CYCLE && start == HK_ANY_START) start = 0;
+    last_n = n;
+    last_start = start;
+    last_objective = objective;
+    last_total = HK_NONE;
+
+    for (mask = 0; mask <= full; ++mask) {
+        row = best[mask];
+        for (last = 0; last < n; ++last) row[last] = HK_NONE;
+    }
+    for (last = 0; last < n; ++last) {
+        if (start == HK_ANY_START || start == last) best[1u << last][last] = 0;
+    }
+
+    /* Subsets only grow, so ascending mask order sees every predecessor
+     * before its successors */
+    for (mask = 1; mask < full; ++mask) {
+        row = best[mask];
+        for (last = 0; last < n; ++last) {
+            cur = row[last];
+            if (cur == HK_NONE) continue;
+            for (next = 0, bit = 1; next < n; ++next, bit <<= 1) {
+                if (mask & bit) continue;
+                w = hk_weight[last][next];
+                if (w == HK_NONE) continue;
+                cand = cur + w;
+                if (better(cand, best[mask | bit][next])) {
+                    best[mask | bit][next] = cand;
+                }
+            }
+        }
+    }
+
+    row = best[full];
+    for (last = 0; last < n; ++last) {
+        cand = row[last];
+        if (cand == HK_NONE) continue;
+        if (shape == HK_CYCLE) {
+            if (n > 1 && last == start) continue;
+            w = hk_weight[last][start];
+            if (w == HK_NONE) continue;
+            cand += w;
+        }
+        if (better(cand, last_total)) {
+            last_total = cand;
+            last_end = last;
+        }
+    }
+    return last_total;
+}
+
+unsigned char hk_path(unsigned char *order) {
+    unsigned int mask = (1u << last_n) - 1;
+    unsigned char pos = last_n;
+    unsigned char cur = last_end;
+    unsigned char prev;
+    int target;
+
+    if (last_total == HK_NONE) return 0;
+
+    /* Walk back from the end, picking any predecessor whose entry plus
+     * the connecting edge reproduces the stored total */
+    while (pos > 0) {
+        order[--pos] = cur;
+        target = best[mask][cur];
+        mask &= ~(1u << cur);
+        if (!mask) break;
+        for (prev = 0; prev < last_n; ++prev) {
+            if (!(mask & (1u << prev))) continue;
+            if (best[mask][prev] == HK_NONE) continue;
+            if (hk_weight[prev][cur] == HK_NONE) continue;
+            if (best[mask][prev] + hk_weight[prev][cur] == target) break;
+        }
+        cur = prev;
+    }
+    return 1;
+}
@@ -0,0 +1,44 @@
+/* heldkarp.h - Shared Held-Karp bitmask DP for small TSP-style puzzles
+ *
+ * Computes the best Hamiltonian path or cycle over up to HK_MAX_NODES
+ * nodes in O(2^n * n^2) time and O(2^n * n) memory, replacing the n!
+ * permutation searches. The caller fills hk_weight[][] (directed; use the
+ * same value both ways for symmetric problems) and picks the objective.
+ */
+
+#ifndef HELDKARP_H
+#define HELDKARP_H
+
+/* 2^10 * 10 ints = 20 KB of DP table, which fits in C64 RAM */
+#ifndef HK_MAX_NODES
+#define HK_MAX_NODES 10
+#endif
+
+/* Objectives */
+#define HK_MINIMIZE 0
+#define HK_MAXIMIZE 1
+
+/* Path shapes */
+#define HK_PATH 0  /* visit every node once, end anywhere */
+#define HK_CYCLE 1 /* visit every node once and return to the start */
+
+/* Start anywhere (paths only) */
+#define HK_ANY_START 0xFF
+
+/* Weight marking a missing edge; also returned when no route exists */
+#define HK_NONE (-32767 - 1)
+
+/* Edge weights, hk_weight[from][to] */
+extern int hk_weight[HK_MAX_NODES][HK_MAX_NODES];
+
+/* Solve over nodes 0..n-1 and return the best total. start is a node
+ * index or HK_ANY_START; cycles always use node 0 when start is
+ * HK_ANY_START. */
+int hk_solve(unsigned char n, unsigned char start, unsigned char objective,
+             unsigned char shape);
+
+/* Write the node order of the last hk_solve result into order[0..n-1].
+ * Returns 0 if there was no valid route. */
+unsigned char hk_path(unsigned char *order);
+
+#endif /* HELDKARP_H */
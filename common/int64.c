@@ -0,0 +1,43 @@
+/* int64.c - Portable parts of the 64-bit integer module
+ *
+ * u64_set is plain C everywhere. The other routines live in int64_6502.s
+ * on cc65; the versions below are only compiled for host builds.
+ */
+
+#include <string.h>
+#include "int64.h"
+
+#ifndef __CC65__
+#include <stdio.h>
+#endif
+
+void u64_set(u64 *a, unsigned long v) {
+#ifdef __CC65__
+    memcpy(a->b, &v, 4);
+    memset(a->b + 4, 0, 4);
+#else
+    *a = v;
+#endif
+}
+
+#ifndef __CC65__
+
+void u64_add(u64 *a, const u64 *b) {
+    *a += *b;
+}
+
+void u64_mul16(u64 *a, unsigned int m) {
+    *a *= (unsigned short)m;
+}
+
+int u64_cmp(const u64 *a, const u64 *b) {
+    if (*a < *b) return -1;
+    return *a > *b;
+}
+
+char *u64_format(const u64 *a, char *buf) {
+    sprintf(buf, "%llu", (unsigned long long)*a);
+    return buf;
+}
+
+#endif /* !__CC65__ */
@@ -0,0 +1,40 @@
+/* int64.h - 64-bit unsigned integers for cc65
+ *
+ * cc65 has no integer type wider than 32 bits. On the C64 the kernels
+ * (add, multiply by 16 bits, compare, decimal format) are 6502 assembly
+ * in int64_6502.s working on 8 little-endian bytes. Host builds use the
+ * native uint64_t versions in int64.c, so solvers can be checked on a PC.
+ */
+
+#ifndef INT64_H
+#define INT64_H
+
+#ifdef __CC65__
+typedef struct {
+    unsigned char b[8]; /* little-endian */
+} u64;
+#else
+#include <stdint.h>
+typedef uint64_t u64;
+#define __fastcall__
+#endif
+
+/* Buffer size for u64_format: 20 digits plus the terminator */
+#define U64_FORMAT_SIZE 21
+
+/* a = v */
+void u64_set(u64 *a, unsigned long v);
+
+/* a += b (modulo 2^64) */
+void __fastcall__ u64_add(u64 *a, const u64 *b);
+
+/* a *= m (modulo 2^64) */
+void __fastcall__ u64_mul16(u64 *a, unsigned int m);
+
+/* -1, 0 or 1 as a is below, equal to or above b */
+int __fastcall__ u64_cmp(const u64 *a, const u64 *b);
+
+/* Write a in decimal to buf (U64_FORMAT_SIZE bytes) and return buf */
+char *__fastcall__ u64_format(const u64 *a, char *buf);
+
+#endif /* INT64_H */
@@ -0,0 +1,176 @@
+;
+; int64_6502.s - 6502 kernels for the 64-bit integer module (see int64.h)
+;
+; All values are 8 bytes, least significant first. Arguments follow the
+; cc65 __fastcall__ convention: the last one arrives in A/X, the first is
+; popped from the C stack.
+;
+
+        .export         _u64_add, _u64_mul16, _u64_cmp, _u64_format
+        .import         popax
+        .importzp       ptr1, ptr2, tmp1, tmp2
+
+        .bss
+
+scratch:        .res    8       ; multiplicand / value being converted
+bcd:            .res    10      ; 20 packed BCD digits, low byte first
+
+        .code
+
+; void __fastcall__ u64_add(u64 *a, const u64 *b);
+
+_u64_add:
+        sta     ptr2
+        stx     ptr2+1          ; b
+        jsr     popax
+        sta     ptr1
+        stx     ptr1+1          ; a
+        ldy     #0
+        ldx     #8
+        clc
+@loop:  lda     (ptr1),y
+        adc     (ptr2),y
+        sta     (ptr1),y
+        iny
+        dex
+        bne     @loop
+        rts
+
+; void __fastcall__ u64_mul16(u64 *a, unsigned int m);
+;
+; Shift-and-add over the multiplier bits, stopping as soon as the rest of
+; the multiplier is zero (puzzle weights usually fit in 7 bits).
+
+_u64_mul16:
+        sta     tmp1
+        stx     tmp2            ; m
+        jsr     popax
+        sta     ptr1
+        stx     ptr1+1          ; a
+        ldy     #7
+@copy:  lda     (ptr1),y        ; scratch = a, a = 0
+        sta     scratch,y
+        lda     #0
+        sta     (ptr1),y
+        dey
+        bpl     @copy
+
+@bit:   lda     tmp1
+        ora     tmp2
+        beq     @done
+        lsr     tmp2
+        ror     tmp1
+        bcc     @shift
+        ldy     #0
+        ldx     #8
+        clc
+@add:   lda     (ptr1),y        ; a += scratch
+        adc     scratch,y
+        sta     (ptr1),y
+        iny
+        dex
+        bne     @add
+@shift: asl     scratch         ; scratch <<= 1
+        .repeat 7, I
+        rol     scratch+I+1
+        .endrepeat
+        jmp     @bit
+@done:  rts
+
+; int __fastcall__ u64_cmp(const u64 *a, const u64 *b);
+
+_u64_cmp:
+        sta     ptr2
+        stx     ptr2+1          ; b
+        jsr     popax
+        sta     ptr1
+        stx     ptr1+1          ; a
+        ldy     #7
+@loop:  lda     (ptr1),y        ; most significant byte first
+        cmp     (ptr2),y
+        bne     @diff
+        dey
+        bpl     @loop
+        lda     #0
+        tax
+        rts
+@diff:  bcc     @less
+        lda     #1
+        ldx     #0
+        rts
+@less:  lda     #$FF
+        tax
+        rts
+
+; char *__fastcall__ u64_format(const u64 *a, char *buf);
+;
+; Double-dabble: shift the 64 bits into a packed BCD accumulator, doubling
+; it with decimal-mode ADC. Interrupts are held off while D is set.
+
+_u64_format:
+        sta     ptr2
+        stx     ptr2+1          ; buf
+        jsr     popax
+        sta     ptr1
+        stx     ptr1+1          ; a
+        ldy     #7
+@copy:  lda     (ptr1),y
+        sta     scratch,y
+        dey
+        bpl     @copy
+        lda     #0
+        ldx     #9
+@clear: sta     bcd,x
+        dex
+        bpl     @clear
+
+        php
+        sei
+        sed
+        ldy     #64
+@bit:   asl     scratch         ; next bit, most significant first
+        .repeat 7, I
+        rol     scratch+I+1
+        .endrepeat
+        .repeat 10, I           ; bcd = bcd * 2 + bit
+        lda     bcd+I
+        adc     bcd+I
+        sta     bcd+I
+        .endrepeat
+        dey
+        bne     @bit
+        plp
+
+        ldy     #0              ; characters written
+        ldx     #9
+@digit: lda     bcd,x
+        lsr     a
+        lsr     a
+        lsr     a
+        lsr     a
+        jsr     emit
+        lda     bcd,x
+        and     #$0F
+        jsr     emit
+        dex
+        bpl     @digit
+        tya
+        bne     @term
+        lda     #'0'            ; the value was zero
+        sta     (ptr2),y
+        iny
+@term:  lda     #0
+        sta     (ptr2),y
+        lda     ptr2
+        ldx     ptr2+1
+        rts
+
+; Store digit A at buf[Y] unless it is a leading zero. Z reflects A on entry.
+
+emit:   bne     @put
+        cpy     #0
+        beq     @skip
+@put:   ora     #'0'
+        sta     (ptr2),y
+        iny
+@skip:  rts
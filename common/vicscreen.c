@@ -0,0 +1,95 @@
+/* vicscreen.c - Text and hi-res grid rendering straight into VIC-II memory */
+
+#include <string.h>
+#include <c64.h>
+#include "vicscreen.h"
+
+#define TEXT_SCREEN ((unsigned char *)0x0400)
+#define BITMAP ((unsigned char *)0xE000)
+#define BITMAP_COLORS ((unsigned char *)0xC000)
+
+/* Screen codes for the 16 quarter-block patterns: bit 0 upper left,
+ * bit 1 upper right, bit 2 lower left, bit 3 lower right */
+static const unsigned char quad_char[16] = {
+    0x20, 0x7E, 0x7C, 0xE2, 0x7B, 0x61, 0xFF, 0xEC,
+    0x6C, 0x7F, 0xE1, 0xFB, 0x62, 0xFC, 0xFE, 0xA0
+};
+
+/* Four cells (lowest bit leftmost) as eight pixels (highest bit leftmost),
+ * each cell two pixels wide */
+static const unsigned char double_bits[16] = {
+    0x00, 0xC0, 0x30, 0xF0, 0x0C, 0xCC, 0x3C, 0xFC,
+    0x03, 0xC3, 0x33, 0xF3, 0x0F, 0xCF, 0x3F, 0xFF
+};
+
+/* Byte offset of each 8-pixel character row of the bitmap */
+static unsigned int char_row[25];
+
+static unsigned char saved_addr;
+
+static unsigned char pixel(const unsigned char *row, unsigned char x) {
+    return (row[x >> 3] >> (x & 7)) & 1;
+}
+
+void vs_text_blocks(unsigned char col, unsigned char row,
+                    const unsigned char *bits, unsigned char stride,
+                    unsigned char width, unsigned char height,
+                    unsigned char color) {
+    const unsigned char *top;
+    const unsigned char *bottom;
+    unsigned char x, y, q;
+    unsigned int offset;
+
+    for (y = 0; y < height; y += 2) {
+        top = bits + y * stride;
+        bottom = (y + 1 < height) ? top + stride : 0;
+        offset = (row + (y >> 1)) * 40 + col;
+        for (x = 0; x < width; x += 2) {
+            q = pixel(top, x);
+            if (x + 1 < width) q |= pixel(top, x + 1) << 1;
+            if (bottom) {
+                q |= pixel(bottom, x) << 2;
+                if (x + 1 < width) q |= pixel(bottom, x + 1) << 3;
+            }
+            TEXT_SCREEN[offset] = quad_char[q];
+            COLOR_RAM[offset] = color;
+            ++offset;
+        }
+    }
+}
+
+void vs_bitmap_on(unsigned char fg, unsigned char bg) {
+    unsigned char i;
+
+    for (i = 0; i < 25; ++i) {
+        char_row[i] = i * 320;
+    }
+    memset(BITMAP, 0, 8000);
+    memset(BITMAP_COLORS, (fg << 4) | (bg & 0x0F), 1000);
+
+    /* Bank 3 ($C000-$FFFF), colours at +$0000, bitmap at +$2000 */
+    saved_addr = VIC.addr;
+    CIA2.pra &= 0xFC;
+    VIC.addr = 0x08;
+    VIC.ctrl1 |= 0x20;
+}
+
+void vs_bitmap_off(void) {
+    VIC.ctrl1 &= ~0x20;
+    VIC.addr = saved_addr;
+    CIA2.pra |= 0x03;
+}
+
+void vs_bitmap_cells(unsigned char row, unsigned char col8,
+                     unsigned char cells) {
+    unsigned char *p;
+    unsigned char left = double_bits[cells & 0x0F];
+    unsigned char right = double_bits[cells >> 4];
+
+    /* Cell row r is pixel rows 2r and 2r + 1; 8 cells span two characters */
+    p = BITMAP + char_row[row >> 2] + (col8 << 4) + ((row & 3) << 1);
+    p[0] = left;
+    p[1] = left;
+    p[8] = right;
+    p[9] = right;
+}
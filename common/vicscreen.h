@@ -0,0 +1,45 @@
+/* vicscreen.h - Draw puzzle grids straight into VIC-II memory
+ *
+ * Two backends, both fed the same packed pixel rows (bit j of byte k is
+ * pixel 8k + j, so the lowest bit is leftmost):
+ *
+ * - Text: 2x2 pixels per character using the PETSCII quarter-block
+ *   characters, written to the default screen at $0400 and its colour RAM.
+ * - Hi-res bitmap: 2x2 screen pixels per cell, in VIC bank 3 with the
+ *   bitmap under the KERNAL at $E000 and its colours at $C000. Programs
+ *   using it must keep the C stack and heap below $C000 by linking with
+ *   -Wl -D,__HIMEM__=0xC000.
+ *
+ * Nothing goes through conio, so redrawing one cell costs a few stores.
+ */
+
+#ifndef VICSCREEN_H
+#define VICSCREEN_H
+
+/* Cells that fit in the bitmap at 2x2 pixels each */
+#define VS_BITMAP_ROWS 100
+#define VS_BITMAP_COLS 160
+
+/* Left edge of the bitmap grid in 8-cell columns, to centre 'cols' cells */
+#define VS_BITMAP_CENTER(cols) ((VS_BITMAP_COLS - (cols)) / 16)
+
+/* Draw a width x height pixel grid at text column 'col', row 'row'. It
+ * takes (width + 1) / 2 x (height + 1) / 2 characters. 'stride' is the
+ * number of bytes per pixel row. */
+void vs_text_blocks(unsigned char col, unsigned char row,
+                    const unsigned char *bits, unsigned char stride,
+                    unsigned char width, unsigned char height,
+                    unsigned char color);
+
+/* Switch to hi-res bitmap mode with every cell off */
+void vs_bitmap_on(unsigned char fg, unsigned char bg);
+
+/* Back to the normal text screen */
+void vs_bitmap_off(void);
+
+/* Draw 8 cells of cell row 'row' (0 to VS_BITMAP_ROWS - 1) starting at
+ * cell column 8 * col8, lowest bit leftmost */
+void vs_bitmap_cells(unsigned char row, unsigned char col8,
+                     unsigned char cells);
+
+#endif /* VICSCREEN_H */